@@ -0,0 +1,330 @@
+/*
+  ==============================================================================
+
+	Offline batch renderer. Pushes audio files through the SimpleMBComp DSP
+	chain using state blobs saved by getStateInformation.
+
+	Usage: BatchRender <job-list> [num-threads]
+
+	The job list has one job per line: input file, output file and state
+	blob, separated by tabs. Blank lines and lines starting with # are
+	ignored.
+
+	Mono and stereo files go through SimpleMBCompAudioProcessor. Files with
+	more channels are stem bundles: every channel is an independent stem,
+	and all of them go through one MultiStemProcessor.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+
+#include "../../SimpleMBComp/Source/MultiStemProcessor.h"
+#include "../../SimpleMBComp/Source/PluginProcessor.h"
+
+using namespace juce;
+
+namespace
+{
+	constexpr int blockSize = 512;
+
+	// How much of the input is mapped at once, so memory stays flat for long files.
+	constexpr int64 mapWindowSamples = 1 << 20;
+
+	struct RenderJob
+	{
+		File input;
+		File output;
+		File state;
+	};
+
+	Result parseJobList(const File& jobList, Array<RenderJob>& jobs)
+	{
+		if (!jobList.existsAsFile())
+			return Result::fail("job list not found: " + jobList.getFullPathName());
+
+		StringArray lines;
+		jobList.readLines(lines);
+
+		auto cwd = File::getCurrentWorkingDirectory();
+
+		for (int i = 0; i < lines.size(); ++i)
+		{
+			auto line = lines[i].trim();
+
+			if (line.isEmpty() || line.startsWithChar('#'))
+				continue;
+
+			auto tokens = StringArray::fromTokens(line, "\t", "\"");
+			tokens.removeEmptyStrings();
+
+			if (tokens.size() != 3)
+				return Result::fail("line " + String(i + 1) + ": expected input, output and state separated by tabs");
+
+			jobs.add({ cwd.getChildFile(tokens[0].unquoted()),
+					   cwd.getChildFile(tokens[1].unquoted()),
+					   cwd.getChildFile(tokens[2].unquoted()) });
+		}
+
+		return Result::ok();
+	}
+
+	/**
+		The APVTS inside the processor is a Timer, so the processor has to be
+		created and destroyed with the message manager locked.
+	*/
+	struct LockedProcessor
+	{
+		LockedProcessor()
+		{
+			const MessageManagerLock mml;
+			processor = std::make_unique<SimpleMBCompAudioProcessor>();
+		}
+
+		~LockedProcessor()
+		{
+			const MessageManagerLock mml;
+			processor.reset();
+		}
+
+		SimpleMBCompAudioProcessor* operator->() const { return processor.get(); }
+
+		std::unique_ptr<SimpleMBCompAudioProcessor> processor;
+	};
+
+	Result renderJob(const RenderJob& job, AudioFormatManager& formats)
+	{
+		auto* inputFormat = formats.findFormatForFileExtension(job.input.getFileExtension());
+		if (inputFormat == nullptr)
+			return Result::fail("unsupported input format");
+
+		std::unique_ptr<MemoryMappedAudioFormatReader> reader(inputFormat->createMemoryMappedReader(job.input));
+		if (reader == nullptr)
+			return Result::fail("input cannot be memory-mapped (WAV or AIFF required)");
+
+		auto numChannels = (int)reader->numChannels;
+		if (numChannels < 1)
+			return Result::fail("input has no channels");
+
+		MemoryBlock state;
+		if (!job.state.loadFileAsData(state))
+			return Result::fail("cannot read state blob " + job.state.getFullPathName());
+
+		// setStateInformation ignores a blob it cannot parse and keeps the defaults,
+		// which would render silently with the wrong settings, so check it first.
+		auto stateTree = ValueTree::readFromData(state.getData(), state.getSize());
+		if (!stateTree.isValid())
+			return Result::fail("corrupt state blob " + job.state.getFullPathName());
+
+		// A fresh processor per job keeps every render independent of what ran before it.
+		LockedProcessor processor;
+
+		if (!stateTree.hasType(processor->apvts.state.getType()))
+			return Result::fail("not a SimpleMBComp state blob: " + job.state.getFullPathName());
+
+		processor->setStateInformation(state.getData(), (int)state.getSize());
+
+		auto* outputFormat = formats.findFormatForFileExtension(job.output.getFileExtension());
+		if (outputFormat == nullptr)
+			return Result::fail("unsupported output format");
+
+		job.output.getParentDirectory().createDirectory();
+		job.output.deleteFile();
+
+		// Render into a temporary sibling and only move it into place once the writer
+		// has finalised it. On any failure the writer, declared after it, is destroyed
+		// first and then the TemporaryFile deletes the partial render, so a failed job
+		// never leaves a truncated but valid-looking file at the output path.
+		TemporaryFile temp(job.output);
+
+		auto stream = std::make_unique<FileOutputStream>(temp.getFile());
+		if (stream->failedToOpen())
+			return Result::fail("cannot open " + temp.getFile().getFullPathName());
+
+		std::unique_ptr<AudioFormatWriter> writer(outputFormat->createWriterFor(stream.get(),
+			reader->sampleRate,
+			(unsigned int)numChannels,
+			(int)reader->bitsPerSample,
+			{},
+			0));
+		if (writer == nullptr)
+			return Result::fail("cannot create writer for " + job.output.getFullPathName());
+
+		stream.release();
+
+		// Stem bundles share the processor's parameters but run on the lane kernels.
+		std::unique_ptr<MultiStemProcessor> stems;
+
+		if (numChannels > 2)
+		{
+			stems = std::make_unique<MultiStemProcessor>(processor->apvts);
+			stems->prepare(reader->sampleRate, blockSize, numChannels);
+		}
+		else
+		{
+			processor->setPlayConfigDetails(numChannels, numChannels, reader->sampleRate, blockSize);
+			processor->prepareToPlay(reader->sampleRate, blockSize);
+		}
+
+		AudioBuffer<float> buffer(numChannels, blockSize);
+		MidiBuffer midi;
+
+		for (int64 windowStart = 0; windowStart < reader->lengthInSamples; windowStart += mapWindowSamples)
+		{
+			auto window = Range<int64>(windowStart, jmin(reader->lengthInSamples, windowStart + mapWindowSamples));
+
+			if (!reader->mapSectionOfFile(window))
+				return Result::fail("cannot map " + job.input.getFullPathName());
+
+			for (auto position = window.getStart(); position < window.getEnd(); position += blockSize)
+			{
+				auto numSamples = (int)jmin((int64)blockSize, window.getEnd() - position);
+				buffer.setSize(numChannels, numSamples, false, false, true);
+
+				reader->read(&buffer, 0, numSamples, position, true, numChannels > 1);
+
+				if (stems != nullptr)
+				{
+					if (!stems->process(buffer.getArrayOfWritePointers(), numChannels, numSamples))
+						return Result::fail("cannot process " + String(numChannels) + " stems");
+				}
+				else
+				{
+					processor->processBlock(buffer, midi);
+				}
+
+				if (!writer->writeFromAudioSampleBuffer(buffer, 0, numSamples))
+					return Result::fail("write failed at sample " + String(position));
+			}
+		}
+
+		if (stems == nullptr)
+			processor->releaseResources();
+
+		// Writes the final header and closes the file before it is moved.
+		writer.reset();
+
+		if (!temp.overwriteTargetFileWithTemporary())
+			return Result::fail("cannot move the render to " + job.output.getFullPathName());
+
+		return Result::ok();
+	}
+
+	//==============================================================================
+	/**
+		Pulls jobs off the shared queue until it is empty. Jobs are whole files,
+		so a single atomic cursor balances the load as well as per-thread
+		deques would.
+	*/
+	class RenderWorker : public Thread
+	{
+	public:
+		RenderWorker(const Array<RenderJob>& jobsToRun, std::atomic<int>& jobCursor, std::vector<String>& jobErrors, CriticalSection& outputLock)
+			: Thread("BatchRender worker"), jobs(jobsToRun), nextJob(jobCursor), errors(jobErrors), consoleLock(outputLock)
+		{
+		}
+
+		void run() override
+		{
+			AudioFormatManager formats;
+			formats.registerBasicFormats();
+
+			while (!threadShouldExit())
+			{
+				auto index = nextJob.fetch_add(1);
+				if (index >= jobs.size())
+					break;
+
+				const auto& job = jobs.getReference(index);
+				auto result = renderJob(job, formats);
+
+				// Each worker writes a distinct index, so no lock is needed here.
+				errors[(size_t)index] = result.getErrorMessage();
+
+				const ScopedLock sl(consoleLock);
+				std::cout << (result.wasOk() ? "done   " : "FAILED ")
+					<< job.input.getFullPathName()
+					<< (result.wasOk() ? String() : ": " + result.getErrorMessage())
+					<< std::endl;
+			}
+		}
+
+	private:
+		const Array<RenderJob>& jobs;
+		std::atomic<int>& nextJob;
+		std::vector<String>& errors;
+		CriticalSection& consoleLock;
+	};
+
+	/** Runs the workers and stops the message loop once they have all finished. */
+	class BatchRenderer : public Thread
+	{
+	public:
+		BatchRenderer(const Array<RenderJob>& jobsToRun, int numThreads)
+			: Thread("BatchRender"), jobs(jobsToRun), errors((size_t)jobsToRun.size())
+		{
+			for (int i = 0; i < numThreads; ++i)
+				workers.add(new RenderWorker(jobs, nextJob, errors, consoleLock));
+		}
+
+		void run() override
+		{
+			for (auto* worker : workers)
+				worker->startThread();
+
+			for (auto* worker : workers)
+				worker->waitForThreadToExit(-1);
+
+			MessageManager::getInstance()->stopDispatchLoop();
+		}
+
+		const std::vector<String>& getErrors() const { return errors; }
+
+	private:
+		const Array<RenderJob>& jobs;
+		std::atomic<int> nextJob{ 0 };
+		std::vector<String> errors;
+		CriticalSection consoleLock;
+		OwnedArray<RenderWorker> workers;
+	};
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+	ScopedJuceInitialiser_GUI juceInitialiser;
+
+	if (argc < 2)
+	{
+		std::cerr << "usage: BatchRender <job-list> [num-threads]" << std::endl;
+		return 1;
+	}
+
+	Array<RenderJob> jobs;
+	auto parsed = parseJobList(File::getCurrentWorkingDirectory().getChildFile(argv[1]), jobs);
+
+	if (parsed.failed())
+	{
+		std::cerr << parsed.getErrorMessage() << std::endl;
+		return 1;
+	}
+
+	auto numThreads = argc > 2 ? String(argv[2]).getIntValue() : SystemStats::getNumCpus();
+	numThreads = jlimit(1, jmax(1, jobs.size()), numThreads);
+
+	BatchRenderer renderer(jobs, numThreads);
+	renderer.startThread();
+
+	// Processors are created and destroyed under a MessageManagerLock, which needs a running loop.
+	MessageManager::getInstance()->runDispatchLoop();
+	renderer.waitForThreadToExit(-1);
+
+	int numFailed = 0;
+	for (auto& error : renderer.getErrors())
+		if (error.isNotEmpty())
+			++numFailed;
+
+	std::cout << jobs.size() - numFailed << " of " << jobs.size() << " jobs rendered" << std::endl;
+
+	return numFailed == 0 ? 0 : 1;
+}
@@ -0,0 +1,304 @@
+/*
+  ==============================================================================
+
+	Lane kernels for MultiStemProcessor: the LR4 crossover and the peak
+	compressor run over interleaved [sample][lane] frames, one stem per lane.
+
+  ==============================================================================
+*/
+
+#include "MultiStemKernels.h"
+
+#include <cmath>
+
+#if SIMPLEMBCOMP_HAS_AVX2_KERNELS
+ #include <immintrin.h>
+
+ // The filter is built without FMA so that it rounds exactly like the scalar
+ // filters in the processor; only the compressor's log/exp uses FMA.
+ #if defined(__GNUC__) || defined(__clang__)
+  #define SIMPLEMBCOMP_AVX2 __attribute__((target("avx2")))
+  #define SIMPLEMBCOMP_AVX2_FMA __attribute__((target("avx2,fma")))
+ #else
+  // MSVC accepts AVX2 and FMA intrinsics in any function without /arch:AVX2.
+  #define SIMPLEMBCOMP_AVX2
+  #define SIMPLEMBCOMP_AVX2_FMA
+ #endif
+#endif
+
+namespace MultiStemKernels
+{
+	namespace
+	{
+		using SharedCoefficients::LinkwitzRiley;
+
+		//==============================================================================
+		// Scalar kernels. The maths is the per-sample maths of SharedDSP.h, with
+		// the lane loop innermost.
+
+		template<FilterType type>
+		void filterScalar(const LinkwitzRiley& c, const float* input, float* output, FilterState state, int numSamples, int numLanes) noexcept
+		{
+			const auto k = c.R2 + c.g;
+
+			for (int n = 0; n < numSamples; ++n)
+			{
+				const auto* in = input + n * numLanes;
+				auto* out = output + n * numLanes;
+
+				for (int lane = 0; lane < numLanes; ++lane)
+				{
+					auto yH = (in[lane] - k * state.s1[lane] - state.s2[lane]) * c.h;
+
+					auto yB = c.g * yH + state.s1[lane];
+					state.s1[lane] = c.g * yH + yB;
+
+					auto yL = c.g * yB + state.s2[lane];
+					state.s2[lane] = c.g * yB + yL;
+
+					if constexpr (type == FilterType::allpass)
+					{
+						out[lane] = yL - c.R2 * yB + yH;
+					}
+					else
+					{
+						auto yH2 = ((type == FilterType::lowpass ? yL : yH) - k * state.s3[lane] - state.s4[lane]) * c.h;
+
+						auto yB2 = c.g * yH2 + state.s3[lane];
+						state.s3[lane] = c.g * yH2 + yB2;
+
+						auto yL2 = c.g * yB2 + state.s4[lane];
+						state.s4[lane] = c.g * yB2 + yL2;
+
+						out[lane] = type == FilterType::lowpass ? yL2 : yH2;
+					}
+				}
+			}
+		}
+
+		void compressScalar(const CompressorSettings& settings, float* frames, float* envelope, int numSamples, int numLanes) noexcept
+		{
+			const auto exponent = settings.ratioInverse - 1.f;
+
+			for (int n = 0; n < numSamples; ++n)
+			{
+				auto* x = frames + n * numLanes;
+
+				for (int lane = 0; lane < numLanes; ++lane)
+				{
+					auto level = std::abs(x[lane]);
+					auto cte = level > envelope[lane] ? settings.cteAT : settings.cteRL;
+					auto env = level + cte * (envelope[lane] - level);
+					envelope[lane] = env;
+
+					auto gain = env < settings.threshold ? 1.f : std::pow(env * settings.thresholdInverse, exponent);
+					x[lane] *= gain;
+				}
+			}
+		}
+
+#if SIMPLEMBCOMP_HAS_AVX2_KERNELS
+		//==============================================================================
+		// AVX2 kernels. Each register holds one sample of 8 stems; the state of
+		// those 8 stems stays in registers for the whole block.
+
+		template<FilterType type>
+		SIMPLEMBCOMP_AVX2 void filterAVX2(const LinkwitzRiley& c, const float* input, float* output, FilterState state, int numSamples, int numLanes) noexcept
+		{
+			const auto g = _mm256_set1_ps(c.g);
+			const auto h = _mm256_set1_ps(c.h);
+			const auto R2 = _mm256_set1_ps(c.R2);
+			const auto k = _mm256_set1_ps(c.R2 + c.g);
+
+			for (int lane = 0; lane < numLanes; lane += laneWidth)
+			{
+				auto s1 = _mm256_loadu_ps(state.s1 + lane);
+				auto s2 = _mm256_loadu_ps(state.s2 + lane);
+				auto s3 = _mm256_loadu_ps(state.s3 + lane);
+				auto s4 = _mm256_loadu_ps(state.s4 + lane);
+
+				for (int n = 0; n < numSamples; ++n)
+				{
+					auto x = _mm256_loadu_ps(input + n * numLanes + lane);
+
+					auto yH = _mm256_mul_ps(_mm256_sub_ps(_mm256_sub_ps(x, _mm256_mul_ps(k, s1)), s2), h);
+
+					auto yB = _mm256_add_ps(_mm256_mul_ps(g, yH), s1);
+					s1 = _mm256_add_ps(_mm256_mul_ps(g, yH), yB);
+
+					auto yL = _mm256_add_ps(_mm256_mul_ps(g, yB), s2);
+					s2 = _mm256_add_ps(_mm256_mul_ps(g, yB), yL);
+
+					__m256 y;
+
+					if constexpr (type == FilterType::allpass)
+					{
+						y = _mm256_add_ps(_mm256_sub_ps(yL, _mm256_mul_ps(R2, yB)), yH);
+					}
+					else
+					{
+						auto yH2 = _mm256_mul_ps(_mm256_sub_ps(_mm256_sub_ps(type == FilterType::lowpass ? yL : yH, _mm256_mul_ps(k, s3)), s4), h);
+
+						auto yB2 = _mm256_add_ps(_mm256_mul_ps(g, yH2), s3);
+						s3 = _mm256_add_ps(_mm256_mul_ps(g, yH2), yB2);
+
+						auto yL2 = _mm256_add_ps(_mm256_mul_ps(g, yB2), s4);
+						s4 = _mm256_add_ps(_mm256_mul_ps(g, yB2), yL2);
+
+						y = type == FilterType::lowpass ? yL2 : yH2;
+					}
+
+					_mm256_storeu_ps(output + n * numLanes + lane, y);
+				}
+
+				_mm256_storeu_ps(state.s1 + lane, s1);
+				_mm256_storeu_ps(state.s2 + lane, s2);
+				_mm256_storeu_ps(state.s3 + lane, s3);
+				_mm256_storeu_ps(state.s4 + lane, s4);
+			}
+		}
+
+		// Natural log and exp with the Cephes single-precision polynomials, which
+		// stay within a few ulp of logf/expf over the range the compressor uses.
+		SIMPLEMBCOMP_AVX2_FMA inline __m256 logAVX2(__m256 x) noexcept
+		{
+			const auto one = _mm256_set1_ps(1.f);
+
+			x = _mm256_max_ps(x, _mm256_castsi256_ps(_mm256_set1_epi32(0x00800000)));
+
+			auto exponent = _mm256_sub_epi32(_mm256_srli_epi32(_mm256_castps_si256(x), 23), _mm256_set1_epi32(0x7f));
+			auto e = _mm256_add_ps(_mm256_cvtepi32_ps(exponent), one);
+
+			// Mantissa in [0.5, 1), then folded into [sqrt(0.5), sqrt(2)) - 1.
+			x = _mm256_and_ps(x, _mm256_castsi256_ps(_mm256_set1_epi32(~0x7f800000)));
+			x = _mm256_or_ps(x, _mm256_set1_ps(0.5f));
+
+			auto isSmall = _mm256_cmp_ps(x, _mm256_set1_ps(0.707106781186547524f), _CMP_LT_OQ);
+			auto tmp = _mm256_and_ps(x, isSmall);
+			x = _mm256_sub_ps(x, one);
+			e = _mm256_sub_ps(e, _mm256_and_ps(one, isSmall));
+			x = _mm256_add_ps(x, tmp);
+
+			auto z = _mm256_mul_ps(x, x);
+
+			auto y = _mm256_set1_ps(7.0376836292e-2f);
+			y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(-1.1514610310e-1f));
+			y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(1.1676998740e-1f));
+			y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(-1.2420140846e-1f));
+			y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(1.4249322787e-1f));
+			y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(-1.6668057665e-1f));
+			y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(2.0000714765e-1f));
+			y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(-2.4999993993e-1f));
+			y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(3.3333331174e-1f));
+			y = _mm256_mul_ps(_mm256_mul_ps(y, x), z);
+
+			y = _mm256_fmadd_ps(e, _mm256_set1_ps(-2.12194440e-4f), y);
+			y = _mm256_fnmadd_ps(z, _mm256_set1_ps(0.5f), y);
+
+			x = _mm256_add_ps(x, y);
+			return _mm256_fmadd_ps(e, _mm256_set1_ps(0.693359375f), x);
+		}
+
+		SIMPLEMBCOMP_AVX2_FMA inline __m256 expAVX2(__m256 x) noexcept
+		{
+			x = _mm256_min_ps(x, _mm256_set1_ps(88.3762626647949f));
+			x = _mm256_max_ps(x, _mm256_set1_ps(-87.3365447504f));
+
+			// x = n ln2 + r, |r| <= ln2 / 2, with ln2 split in two for accuracy.
+			auto n = _mm256_floor_ps(_mm256_fmadd_ps(x, _mm256_set1_ps(1.44269504088896341f), _mm256_set1_ps(0.5f)));
+			x = _mm256_fnmadd_ps(n, _mm256_set1_ps(0.693359375f), x);
+			x = _mm256_fnmadd_ps(n, _mm256_set1_ps(-2.12194440e-4f), x);
+
+			auto z = _mm256_mul_ps(x, x);
+
+			auto y = _mm256_set1_ps(1.9875691500e-4f);
+			y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(1.3981999507e-3f));
+			y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(8.3334519073e-3f));
+			y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(4.1665795894e-2f));
+			y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(1.6666665459e-1f));
+			y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(5.0000001201e-1f));
+			y = _mm256_fmadd_ps(y, z, _mm256_add_ps(x, _mm256_set1_ps(1.f)));
+
+			auto scale = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvttps_epi32(n), _mm256_set1_epi32(0x7f)), 23);
+			return _mm256_mul_ps(y, _mm256_castsi256_ps(scale));
+		}
+
+		SIMPLEMBCOMP_AVX2_FMA void compressAVX2(const CompressorSettings& settings, float* frames, float* envelope, int numSamples, int numLanes) noexcept
+		{
+			const auto one = _mm256_set1_ps(1.f);
+			const auto absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+			const auto cteAT = _mm256_set1_ps(settings.cteAT);
+			const auto cteRL = _mm256_set1_ps(settings.cteRL);
+			const auto threshold = _mm256_set1_ps(settings.threshold);
+			const auto thresholdInverse = _mm256_set1_ps(settings.thresholdInverse);
+			const auto exponent = _mm256_set1_ps(settings.ratioInverse - 1.f);
+
+			for (int lane = 0; lane < numLanes; lane += laneWidth)
+			{
+				auto yold = _mm256_loadu_ps(envelope + lane);
+
+				for (int n = 0; n < numSamples; ++n)
+				{
+					auto* frame = frames + n * numLanes + lane;
+					auto x = _mm256_loadu_ps(frame);
+
+					auto level = _mm256_and_ps(x, absMask);
+					auto cte = _mm256_blendv_ps(cteRL, cteAT, _mm256_cmp_ps(level, yold, _CMP_GT_OQ));
+					auto env = _mm256_add_ps(level, _mm256_mul_ps(cte, _mm256_sub_ps(yold, level)));
+					yold = env;
+
+					auto isBelow = _mm256_cmp_ps(env, threshold, _CMP_LT_OQ);
+
+					// Below threshold on every lane is the common case: skip the log/exp.
+					if (_mm256_movemask_ps(isBelow) != 0xff)
+					{
+						auto gain = expAVX2(_mm256_mul_ps(exponent, logAVX2(_mm256_mul_ps(env, thresholdInverse))));
+						x = _mm256_mul_ps(_mm256_blendv_ps(gain, one, isBelow), x);
+						_mm256_storeu_ps(frame, x);
+					}
+				}
+
+				_mm256_storeu_ps(envelope + lane, yold);
+			}
+		}
+#endif
+
+		//==============================================================================
+		void filterScalar(const LinkwitzRiley& c, FilterType type, const float* input, float* output, FilterState state, int numSamples, int numLanes) noexcept
+		{
+			switch (type)
+			{
+				case FilterType::lowpass:  filterScalar<FilterType::lowpass>(c, input, output, state, numSamples, numLanes); break;
+				case FilterType::highpass: filterScalar<FilterType::highpass>(c, input, output, state, numSamples, numLanes); break;
+				case FilterType::allpass:  filterScalar<FilterType::allpass>(c, input, output, state, numSamples, numLanes); break;
+			}
+		}
+
+		const Kernels scalarKernels{ filterScalar, compressScalar, false };
+
+#if SIMPLEMBCOMP_HAS_AVX2_KERNELS
+		SIMPLEMBCOMP_AVX2 void filterAVX2(const LinkwitzRiley& c, FilterType type, const float* input, float* output, FilterState state, int numSamples, int numLanes) noexcept
+		{
+			switch (type)
+			{
+				case FilterType::lowpass:  filterAVX2<FilterType::lowpass>(c, input, output, state, numSamples, numLanes); break;
+				case FilterType::highpass: filterAVX2<FilterType::highpass>(c, input, output, state, numSamples, numLanes); break;
+				case FilterType::allpass:  filterAVX2<FilterType::allpass>(c, input, output, state, numSamples, numLanes); break;
+			}
+		}
+
+		const Kernels avx2Kernels{ filterAVX2, compressAVX2, true };
+#endif
+	}
+
+	const Kernels& get(bool useAVX2) noexcept
+	{
+#if SIMPLEMBCOMP_HAS_AVX2_KERNELS
+		if (useAVX2)
+			return avx2Kernels;
+#endif
+
+		(void)useAVX2;
+		return scalarKernels;
+	}
+}
@@ -0,0 +1,77 @@
+/*
+  ==============================================================================
+
+	Lane kernels for MultiStemProcessor: the LR4 crossover and the peak
+	compressor run over interleaved [sample][lane] frames, one stem per lane.
+
+	There is a portable scalar version and, on x86, an AVX2/FMA version that
+	works on 8 lanes per register. The AVX2 functions are compiled for that
+	target on their own, so the rest of the build needs no extra flags;
+	callers pick a set at runtime with get().
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "SharedCoefficients.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+ #define SIMPLEMBCOMP_HAS_AVX2_KERNELS 1
+#else
+ #define SIMPLEMBCOMP_HAS_AVX2_KERNELS 0
+#endif
+
+namespace MultiStemKernels
+{
+	/** Lanes per AVX2 register. Lane counts passed to the kernels are multiples of this. */
+	constexpr int laneWidth = 8;
+
+	enum class FilterType
+	{
+		lowpass,
+		highpass,
+		allpass
+	};
+
+	/** Per-lane filter state, numLanes floats each. */
+	struct FilterState
+	{
+		float* s1;
+		float* s2;
+		float* s3;
+		float* s4;
+	};
+
+	/** Same meaning as the members of SharedCompressor. */
+	struct CompressorSettings
+	{
+		float cteAT;
+		float cteRL;
+		float threshold;
+		float thresholdInverse;
+		float ratioInverse;
+	};
+
+	/** input may be the same as output. */
+	using FilterFunction = void (*)(const SharedCoefficients::LinkwitzRiley&, FilterType,
+		const float* input, float* output, FilterState, int numSamples, int numLanes) noexcept;
+
+	/** Compresses the frames in place; envelope holds numLanes floats. */
+	using CompressFunction = void (*)(const CompressorSettings&, float* frames, float* envelope,
+		int numSamples, int numLanes) noexcept;
+
+	struct Kernels
+	{
+		FilterFunction filter;
+		CompressFunction compress;
+		bool isAVX2;
+	};
+
+	/**
+		Returns the AVX2 kernels if asked for and compiled in, otherwise the
+		scalar ones. Only ask for AVX2 once the CPU is known to support AVX2
+		and FMA.
+	*/
+	const Kernels& get(bool useAVX2) noexcept;
+}
@@ -0,0 +1,306 @@
+/*
+  ==============================================================================
+
+	Batch version of the SimpleMBComp signal chain. Runs the same multiband
+	settings over several independent mono stems at once, one stem per lane.
+
+  ==============================================================================
+*/
+
+#include "MultiStemProcessor.h"
+
+//==============================================================================
+// The lane kernels mirror SharedLinkwitzRileyFilter and SharedCompressor, and
+// take their coefficients from the same process-wide cache, so that the output
+// matches SimpleMBCompAudioProcessor.
+
+void MultiStemProcessor::FilterLanes::prepare(double newSampleRate, int numLanes)
+{
+	sampleRate = newSampleRate;
+
+	for (auto* state : { &s1, &s2, &s3, &s4 })
+		state->assign(static_cast<size_t>(numLanes), 0.f);
+
+	coefficients.set(sampleRate, cutoff);
+}
+
+void MultiStemProcessor::FilterLanes::reset()
+{
+	for (auto* state : { &s1, &s2, &s3, &s4 })
+		std::fill(state->begin(), state->end(), 0.f);
+}
+
+void MultiStemProcessor::FilterLanes::setCutoffFrequency(float newCutoff)
+{
+	cutoff = newCutoff;
+
+	if (sampleRate > 0)
+		coefficients.set(sampleRate, cutoff);
+}
+
+void MultiStemProcessor::FilterLanes::process(const MultiStemKernels::Kernels& kernels, const float* input, float* output, int numSamples, int numLanes)
+{
+	kernels.filter(coefficients.get(), type, input, output, { s1.data(), s2.data(), s3.data(), s4.data() }, numSamples, numLanes);
+
+	for (auto* state : { &s1, &s2, &s3, &s4 })
+		for (auto& element : *state)
+			util::snapToZero(element);
+}
+
+//==============================================================================
+void MultiStemProcessor::CompressorLanes::prepare(double newSampleRate, int numLanes)
+{
+	sampleRate = newSampleRate;
+	envelope.assign(static_cast<size_t>(numLanes), 0.f);
+
+	updateCompressorSettings();
+}
+
+void MultiStemProcessor::CompressorLanes::reset()
+{
+	std::fill(envelope.begin(), envelope.end(), 0.f);
+}
+
+void MultiStemProcessor::CompressorLanes::updateCompressorSettings()
+{
+	attackCoefficients.set(sampleRate, attack->get());
+	releaseCoefficients.set(sampleRate, release->get());
+	settings.cteAT = attackCoefficients.get().cte;
+	settings.cteRL = releaseCoefficients.get().cte;
+
+	if (auto value = threshold->get(); !SharedCoefficients::isSameSetting(value, thresholdDb))
+	{
+		thresholdDb = value;
+		settings.threshold = Decibels::decibelsToGain(thresholdDb, -200.f);
+		settings.thresholdInverse = 1.f / settings.threshold;
+	}
+
+	settings.ratioInverse = 1.f / ratio->get();
+}
+
+void MultiStemProcessor::CompressorLanes::process(const MultiStemKernels::Kernels& kernels, float* data, int numSamples, int numLanes)
+{
+	if (isBypassed->get())
+		return;
+
+	kernels.compress(settings, data, envelope.data(), numSamples, numLanes);
+}
+
+//==============================================================================
+MultiStemProcessor::MultiStemProcessor(SimpleMBCompAudioProcessor::APVTS& apvts)
+{
+	using namespace Params;
+	const auto& params = GetParams();
+
+	auto floatHelper = [&apvts, &params](auto& param, const auto& paramName)
+	{
+		param = dynamic_cast<AudioParameterFloat*>(apvts.getParameter(params.at(paramName)));
+		jassert(param != nullptr);
+	};
+
+	auto boolHelper = [&apvts, &params](auto& param, const auto& paramName)
+	{
+		param = dynamic_cast<AudioParameterBool*>(apvts.getParameter(params.at(paramName)));
+		jassert(param != nullptr);
+	};
+
+	auto& low = compressors[0];
+	auto& mid = compressors[1];
+	auto& high = compressors[2];
+
+	floatHelper(inputGainParam, Names::Gain_In);
+	floatHelper(outputGainParam, Names::Gain_Out);
+
+	floatHelper(low.attack, Names::Attack_Low_Band);
+	floatHelper(low.release, Names::Release_Low_Band);
+	floatHelper(low.threshold, Names::Threshold_Low_Band);
+	floatHelper(low.ratio, Names::Ratio_Low_Band);
+	boolHelper(low.isBypassed, Names::Bypassed_Low_Band);
+	boolHelper(low.isMuted, Names::Mute_Low_Band);
+	boolHelper(low.isSoloed, Names::Solo_Low_Band);
+
+	floatHelper(mid.attack, Names::Attack_Mid_Band);
+	floatHelper(mid.release, Names::Release_Mid_Band);
+	floatHelper(mid.threshold, Names::Threshold_Mid_Band);
+	floatHelper(mid.ratio, Names::Ratio_Mid_Band);
+	boolHelper(mid.isBypassed, Names::Bypassed_Mid_Band);
+	boolHelper(mid.isMuted, Names::Mute_Mid_Band);
+	boolHelper(mid.isSoloed, Names::Solo_Mid_Band);
+
+	floatHelper(high.attack, Names::Attack_High_Band);
+	floatHelper(high.release, Names::Release_High_Band);
+	floatHelper(high.threshold, Names::Threshold_High_Band);
+	floatHelper(high.ratio, Names::Ratio_High_Band);
+	boolHelper(high.isBypassed, Names::Bypassed_High_Band);
+	boolHelper(high.isMuted, Names::Mute_High_Band);
+	boolHelper(high.isSoloed, Names::Solo_High_Band);
+
+	floatHelper(lowMidCrossover, Names::Low_Mid_Crossover_Freq);
+	floatHelper(midHighCrossover, Names::Mid_High_Crossover_Freq);
+
+	using MultiStemKernels::FilterType;
+
+	LP1.type = FilterType::lowpass;
+	HP1.type = FilterType::highpass;
+	AP2.type = FilterType::allpass;
+	LP2.type = FilterType::lowpass;
+	HP2.type = FilterType::highpass;
+}
+
+void MultiStemProcessor::prepare(double sampleRate, int maximumBlockSize, int maximumNumStems, bool allowAVX2)
+{
+	jassert(maximumBlockSize > 0);
+	jassert(maximumNumStems > 0);
+
+	kernels = &MultiStemKernels::get(allowAVX2 && SystemStats::hasAVX2() && SystemStats::hasFMA3());
+
+	maxBlockSize = maximumBlockSize;
+	maxNumStems = maximumNumStems;
+	// Pad to whole registers so the lane loops never need a scalar tail.
+	numLanes = (maximumNumStems + laneWidth - 1) / laneWidth * laneWidth;
+
+	for (auto& comp : compressors)
+		comp.prepare(sampleRate, numLanes);
+
+	for (auto* filter : { &LP1, &HP1, &AP2, &LP2, &HP2 })
+		filter->prepare(sampleRate, numLanes);
+
+	// Same behaviour as dsp::Gain: start from silence and ramp over 50 ms.
+	inputGain = SmoothedValue<float>();
+	outputGain = SmoothedValue<float>();
+	inputGain.reset(sampleRate, 0.05);
+	outputGain.reset(sampleRate, 0.05);
+
+	const auto frameSize = static_cast<size_t>(maxBlockSize * numLanes);
+	inputFrames.assign(frameSize, 0.f);
+	highPassFrames.assign(frameSize, 0.f);
+	for (auto& frames : bandFrames)
+		frames.assign(frameSize, 0.f);
+	gains.assign(static_cast<size_t>(maxBlockSize), 0.f);
+}
+
+void MultiStemProcessor::reset()
+{
+	for (auto& comp : compressors)
+		comp.reset();
+
+	for (auto* filter : { &LP1, &HP1, &AP2, &LP2, &HP2 })
+		filter->reset();
+
+	inputGain.setCurrentAndTargetValue(inputGain.getTargetValue());
+	outputGain.setCurrentAndTargetValue(outputGain.getTargetValue());
+}
+
+void MultiStemProcessor::updateState()
+{
+	for (auto& comp : compressors)
+		comp.updateCompressorSettings();
+
+	auto lowMidCutoff = lowMidCrossover->get();
+	LP1.setCutoffFrequency(lowMidCutoff);
+	HP1.setCutoffFrequency(lowMidCutoff);
+
+	auto midHighCutoff = midHighCrossover->get();
+	AP2.setCutoffFrequency(midHighCutoff);
+	LP2.setCutoffFrequency(midHighCutoff);
+	HP2.setCutoffFrequency(midHighCutoff);
+
+	inputGain.setTargetValue(Decibels::decibelsToGain(inputGainParam->get()));
+	outputGain.setTargetValue(Decibels::decibelsToGain(outputGainParam->get()));
+}
+
+void MultiStemProcessor::applyGain(float* frames, SmoothedValue<float>& gain, int numSamples)
+{
+	if (!gain.isSmoothing())
+	{
+		FloatVectorOperations::multiply(frames, gain.getTargetValue(), numSamples * numLanes);
+		return;
+	}
+
+	for (size_t n = 0; n < static_cast<size_t>(numSamples); ++n)
+		gains[n] = gain.getNextValue();
+
+	for (int n = 0; n < numSamples; ++n)
+		FloatVectorOperations::multiply(frames + n * numLanes, gains[static_cast<size_t>(n)], numLanes);
+}
+
+bool MultiStemProcessor::process(float* const* stems, int numStems, int numSamples)
+{
+	// Not prepared yet, or more stems than there are lanes for: processing only
+	// some of them would pass the rest through dry without anyone noticing.
+	if (numLanes == 0 || numStems > maxNumStems)
+	{
+		jassertfalse;
+		return false;
+	}
+
+	ScopedNoDenormals noDenormals;
+
+	updateState();
+
+	// The scratch frames only hold maxBlockSize samples.
+	for (int start = 0; start < numSamples; start += maxBlockSize)
+		processChunk(stems, start, numStems, jmin(maxBlockSize, numSamples - start));
+
+	return true;
+}
+
+void MultiStemProcessor::processChunk(float* const* stems, int startSample, int numStems, int numSamples)
+{
+	// Lanes past numStems carry silence so they stay denormal-free and cost nothing extra.
+	for (int n = 0; n < numSamples; ++n)
+	{
+		auto* frame = inputFrames.data() + n * numLanes;
+
+		for (int stem = 0; stem < numStems; ++stem)
+			frame[stem] = stems[stem][startSample + n];
+
+		std::fill(frame + numStems, frame + numLanes, 0.f);
+	}
+
+	applyGain(inputFrames.data(), inputGain, numSamples);
+
+	LP1.process(*kernels, inputFrames.data(), bandFrames[0].data(), numSamples, numLanes);
+	AP2.process(*kernels, bandFrames[0].data(), bandFrames[0].data(), numSamples, numLanes);
+	HP1.process(*kernels, inputFrames.data(), highPassFrames.data(), numSamples, numLanes);
+	LP2.process(*kernels, highPassFrames.data(), bandFrames[1].data(), numSamples, numLanes);
+	HP2.process(*kernels, highPassFrames.data(), bandFrames[2].data(), numSamples, numLanes);
+
+	for (size_t i = 0; i < bandFrames.size(); ++i)
+		compressors[i].process(*kernels, bandFrames[i].data(), numSamples, numLanes);
+
+	bool isAnySoloed = false;
+
+	for (auto& comp : compressors)
+	{
+		if (comp.isSoloed->get())
+		{
+			isAnySoloed = true;
+			break;
+		}
+	}
+
+	// Reuse the input scratch as the sum, in the same band order as processBlock.
+	auto* sum = inputFrames.data();
+	const auto frameSize = numSamples * numLanes;
+	FloatVectorOperations::clear(sum, frameSize);
+
+	for (size_t i = 0; i < compressors.size(); ++i)
+	{
+		auto isAudible = isAnySoloed ? compressors[i].isSoloed->get()
+									 : !compressors[i].isMuted->get();
+
+		if (isAudible)
+			FloatVectorOperations::add(sum, bandFrames[i].data(), frameSize);
+	}
+
+	applyGain(sum, outputGain, numSamples);
+
+	for (int n = 0; n < numSamples; ++n)
+	{
+		const auto* frame = sum + n * numLanes;
+
+		for (int stem = 0; stem < numStems; ++stem)
+			stems[stem][startSample + n] = frame[stem];
+	}
+}
@@ -0,0 +1,123 @@
+/*
+  ==============================================================================
+
+	Batch version of the SimpleMBComp signal chain. Runs the same multiband
+	settings over several independent mono stems at once, one stem per lane.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "MultiStemKernels.h"
+#include "PluginProcessor.h"
+
+//==============================================================================
+/**
+	Processes N independent stems with the settings held in an APVTS.
+
+	All filter and compressor state is stored structure-of-arrays and the
+	lane kernels in MultiStemKernels run across stems rather than across
+	samples: 8 stems per register on CPUs with AVX2 and FMA, a scalar loop
+	elsewhere. Each stem is treated like one channel of a separate
+	SimpleMBCompAudioProcessor.
+*/
+class MultiStemProcessor
+{
+public:
+	explicit MultiStemProcessor(SimpleMBCompAudioProcessor::APVTS& apvts);
+
+	/** allowAVX2 = false forces the scalar kernels even on CPUs that have AVX2. */
+	void prepare(double sampleRate, int maximumBlockSize, int maximumNumStems, bool allowAVX2 = true);
+	void reset();
+
+	/**
+		Processes the stems in place. Blocks longer than the prepared maximum
+		are processed in chunks of that size.
+
+		Returns false, without touching any stem, if there are more stems than
+		prepare() was given room for or prepare() has not been called. Making
+		room here would allocate, so call prepare() again instead.
+	*/
+	[[nodiscard]] bool process(float* const* stems, int numStems, int numSamples);
+
+	bool isUsingAVX2() const noexcept { return kernels->isAVX2; }
+
+	static constexpr int laneWidth = MultiStemKernels::laneWidth;
+
+private:
+	struct FilterLanes
+	{
+		MultiStemKernels::FilterType type{ MultiStemKernels::FilterType::lowpass };
+
+		void prepare(double newSampleRate, int numLanes);
+		void reset();
+		void setCutoffFrequency(float newCutoff);
+		void process(const MultiStemKernels::Kernels& kernels, const float* input, float* output, int numSamples, int numLanes);
+
+	private:
+		double sampleRate{ 0 };
+		float cutoff{ 2000.f };
+
+		// Shared with every filter and processor at the same settings.
+		SharedCoefficients::LinkwitzRileyHandle coefficients;
+		std::vector<float> s1, s2, s3, s4;
+	};
+
+	struct CompressorLanes
+	{
+		AudioParameterFloat* attack{ nullptr };
+		AudioParameterFloat* release{ nullptr };
+		AudioParameterFloat* threshold{ nullptr };
+		AudioParameterFloat* ratio{ nullptr };
+		AudioParameterBool* isBypassed{ nullptr };
+		AudioParameterBool* isMuted{ nullptr };
+		AudioParameterBool* isSoloed{ nullptr };
+
+		void prepare(double newSampleRate, int numLanes);
+		void reset();
+		void updateCompressorSettings();
+		void process(const MultiStemKernels::Kernels& kernels, float* data, int numSamples, int numLanes);
+
+	private:
+		double sampleRate{ 0 };
+		float thresholdDb{ 0.f };
+		MultiStemKernels::CompressorSettings settings{ 0.f, 0.f, 1.f, 1.f, 1.f };
+
+		// Shared with every compressor and processor at the same settings.
+		SharedCoefficients::BallisticsHandle attackCoefficients, releaseCoefficients;
+		std::vector<float> envelope;
+	};
+
+	std::array<CompressorLanes, 3> compressors;
+	//	   fc0  fc1
+	FilterLanes LP1, AP2,
+		HP1, LP2,
+		HP2;
+
+	AudioParameterFloat* lowMidCrossover{ nullptr };
+	AudioParameterFloat* midHighCrossover{ nullptr };
+
+	SmoothedValue<float> inputGain, outputGain;
+	AudioParameterFloat* inputGainParam{ nullptr };
+	AudioParameterFloat* outputGainParam{ nullptr };
+
+	const MultiStemKernels::Kernels* kernels{ &MultiStemKernels::get(false) };
+
+	int maxBlockSize{ 0 };
+	int maxNumStems{ 0 };
+	int numLanes{ 0 };
+
+	// Interleaved [sample][lane] scratch: the gained input, the HP1 output and one per band.
+	std::vector<float> inputFrames, highPassFrames;
+	std::array<std::vector<float>, 3> bandFrames;
+	std::vector<float> gains;
+
+	void updateState();
+	void applyGain(float* frames, SmoothedValue<float>& gain, int numSamples);
+	void processChunk(float* const* stems, int startSample, int numStems, int numSamples);
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MultiStemProcessor)
+};
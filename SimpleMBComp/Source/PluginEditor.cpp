@@ -9,32 +9,399 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 
+namespace
+{
+    juce::String getKnobLabel (Params::Names name)
+    {
+        using namespace Params;
+
+        switch (name)
+        {
+            case Gain_In:                   return "Input";
+            case Gain_Out:                  return "Output";
+            case Low_Mid_Crossover_Freq:    return "Low-Mid";
+            case Mid_High_Crossover_Freq:   return "Mid-High";
+            case Threshold_Low_Band:
+            case Threshold_Mid_Band:
+            case Threshold_High_Band:       return "Threshold";
+            case Ratio_Low_Band:
+            case Ratio_Mid_Band:
+            case Ratio_High_Band:           return "Ratio";
+            case Attack_Low_Band:
+            case Attack_Mid_Band:
+            case Attack_High_Band:          return "Attack";
+            case Release_Low_Band:
+            case Release_Mid_Band:
+            case Release_High_Band:         return "Release";
+            case Bypassed_Low_Band:
+            case Bypassed_Mid_Band:
+            case Bypassed_High_Band:
+            case Mute_Low_Band:
+            case Mute_Mid_Band:
+            case Mute_High_Band:
+            case Solo_Low_Band:
+            case Solo_Mid_Band:
+            case Solo_High_Band:            break;
+        }
+
+        return {};
+    }
+
+    juce::String getUnitSuffix (Params::Names name)
+    {
+        using namespace Params;
+
+        switch (name)
+        {
+            case Low_Mid_Crossover_Freq:
+            case Mid_High_Crossover_Freq:   return " Hz";
+            case Ratio_Low_Band:
+            case Ratio_Mid_Band:
+            case Ratio_High_Band:           return ":1";
+            case Attack_Low_Band:
+            case Attack_Mid_Band:
+            case Attack_High_Band:
+            case Release_Low_Band:
+            case Release_Mid_Band:
+            case Release_High_Band:         return " ms";
+            case Gain_In:
+            case Gain_Out:
+            case Threshold_Low_Band:
+            case Threshold_Mid_Band:
+            case Threshold_High_Band:       return " dB";
+            case Bypassed_Low_Band:
+            case Bypassed_Mid_Band:
+            case Bypassed_High_Band:
+            case Mute_Low_Band:
+            case Mute_Mid_Band:
+            case Mute_High_Band:
+            case Solo_Low_Band:
+            case Solo_Mid_Band:
+            case Solo_High_Band:            break;
+        }
+
+        return {};
+    }
+
+    Params::Names forBand (Params::Names lowBandName, size_t band)
+    {
+        return static_cast<Params::Names> (static_cast<size_t> (lowBandName) + band);
+    }
+
+    const std::array<const char*, 3> bandTitles { "Low", "Mid", "High" };
+}
+
 //==============================================================================
 SimpleMBCompAudioProcessorEditor::SimpleMBCompAudioProcessorEditor (SimpleMBCompAudioProcessor& p)
     : AudioProcessorEditor (&p), audioProcessor (p)
 {
+    for (const auto& [name, id] : Params::GetParams())
+        paramsByName[(size_t) name] = audioProcessor.apvts.getParameter (id);
+
+    nameForParameterIndex.assign ((size_t) audioProcessor.getParameters().size(), -1);
+
+    attachSlider (inputGain, Names::Gain_In);
+    attachSlider (lowMidCrossover, Names::Low_Mid_Crossover_Freq);
+    attachSlider (midHighCrossover, Names::Mid_High_Crossover_Freq);
+    attachSlider (outputGain, Names::Gain_Out);
+
+    for (size_t i = 0; i < bands.size(); ++i)
+    {
+        auto& band = bands[i];
+
+        attachSlider (band.threshold, forBand (Names::Threshold_Low_Band, i));
+        attachSlider (band.ratio, forBand (Names::Ratio_Low_Band, i));
+        attachSlider (band.attack, forBand (Names::Attack_Low_Band, i));
+        attachSlider (band.release, forBand (Names::Release_Low_Band, i));
+
+        attachButton (band.bypass, forBand (Names::Bypassed_Low_Band, i));
+        attachButton (band.mute, forBand (Names::Mute_Low_Band, i));
+        attachButton (band.solo, forBand (Names::Solo_Low_Band, i));
+
+        band.bypass.setColour (juce::TextButton::buttonOnColourId, juce::Colours::orange.darker());
+        band.mute.setColour (juce::TextButton::buttonOnColourId, juce::Colours::red.darker());
+        band.solo.setColour (juce::TextButton::buttonOnColourId, juce::Colours::gold.darker());
+    }
+
+    // Everything we draw ourselves covers the whole editor, so nothing behind it needs repainting.
+    setOpaque (true);
+
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
-    setSize (400, 300);
+    setSize (640, 460);
 }
 
 SimpleMBCompAudioProcessorEditor::~SimpleMBCompAudioProcessorEditor()
 {
+    for (size_t i = 0; i < paramsByName.size(); ++i)
+        if (slidersByParam[i] != nullptr || buttonsByParam[i] != nullptr)
+            paramsByName[i]->removeListener (this);
+
+    cancelPendingUpdate();
+    stopTimer();
+}
+
+void SimpleMBCompAudioProcessorEditor::attachSlider (juce::Slider& slider, Names name)
+{
+    auto* param = paramsByName[(size_t) name];
+    jassert (param != nullptr);
+
+    slider.setSliderStyle (juce::Slider::RotaryHorizontalVerticalDrag);
+    slider.setTextBoxStyle (juce::Slider::NoTextBox, false, 0, 0);
+    slider.setRange (0.0, 1.0);
+    slider.setValue (param->getValue(), juce::dontSendNotification);
+    slider.setDoubleClickReturnValue (true, param->getDefaultValue());
+    addAndMakeVisible (slider);
+
+    // GUI -> parameter only. Parameter -> GUI goes through flushDirtyReadouts().
+    slider.onDragStart = [param] { param->beginChangeGesture(); };
+    slider.onDragEnd = [this, param]
+    {
+        param->endChangeGesture();
+
+        // Catch up on anything that changed the parameter while the knob was held.
+        triggerAsyncUpdate();
+    };
+
+    slider.onValueChange = [&slider, param]
+    {
+        auto value = (float) slider.getValue();
+
+        if (slider.isMouseButtonDown())
+        {
+            param->setValueNotifyingHost (value);
+        }
+        else
+        {
+            // Wheel, keyboard or double-click: a gesture of its own.
+            param->beginChangeGesture();
+            param->setValueNotifyingHost (value);
+            param->endChangeGesture();
+        }
+    };
+
+    slidersByParam[(size_t) name] = &slider;
+    listenTo (name);
+}
+
+void SimpleMBCompAudioProcessorEditor::attachButton (juce::Button& button, Names name)
+{
+    auto* param = paramsByName[(size_t) name];
+    jassert (param != nullptr);
+
+    button.setClickingTogglesState (true);
+    button.setToggleState (param->getValue() >= 0.5f, juce::dontSendNotification);
+    addAndMakeVisible (button);
+
+    button.onClick = [&button, param]
+    {
+        param->beginChangeGesture();
+        param->setValueNotifyingHost (button.getToggleState() ? 1.0f : 0.0f);
+        param->endChangeGesture();
+    };
+
+    buttonsByParam[(size_t) name] = &button;
+    listenTo (name);
+}
+
+void SimpleMBCompAudioProcessorEditor::listenTo (Names name)
+{
+    auto* param = paramsByName[(size_t) name];
+
+    nameForParameterIndex[(size_t) param->getParameterIndex()] = name;
+    param->addListener (this);
 }
 
 //==============================================================================
 void SimpleMBCompAudioProcessorEditor::paint (juce::Graphics& g)
 {
-    // (Our component is opaque, so we must completely fill the background with a solid colour)
-    g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
+    // The scale can change without a resize, e.g. when the window moves to another display.
+    auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+
+    if (! background.isValid() || ! juce::approximatelyEqual (scale, backgroundScale))
+        renderBackground (scale);
+
+    if (background.isValid())
+        g.drawImage (background, getLocalBounds().toFloat());
 
     g.setColour (juce::Colours::white);
-    g.setFont (15.0f);
-    g.drawFittedText ("Hello World!", getLocalBounds(), juce::Justification::centred, 1);
+    g.setFont (13.0f);
+
+    for (size_t i = 0; i < slidersByParam.size(); ++i)
+    {
+        if (slidersByParam[i] == nullptr || ! g.clipRegionIntersects (readoutBounds[i]))
+            continue;
+
+        g.drawFittedText (getReadoutText ((Names) i), readoutBounds[i], juce::Justification::centred, 1);
+    }
 }
 
 void SimpleMBCompAudioProcessorEditor::resized()
 {
-    // This is generally where you'll want to lay out the positions of any
-    // subcomponents in your editor..
+    auto bounds = getLocalBounds().reduced (8);
+    bounds.removeFromTop (28);
+
+    globalBounds = bounds.removeFromTop (120);
+    bounds.removeFromTop (8);
+
+    auto row = globalBounds.reduced (4);
+    auto cellWidth = row.getWidth() / 4;
+    layoutKnob (inputGain, Names::Gain_In, row.removeFromLeft (cellWidth));
+    layoutKnob (lowMidCrossover, Names::Low_Mid_Crossover_Freq, row.removeFromLeft (cellWidth));
+    layoutKnob (midHighCrossover, Names::Mid_High_Crossover_Freq, row.removeFromLeft (cellWidth));
+    layoutKnob (outputGain, Names::Gain_Out, row);
+
+    auto bandWidth = bounds.getWidth() / (int) bands.size();
+
+    for (size_t i = 0; i < bands.size(); ++i)
+    {
+        auto& band = bands[i];
+
+        auto column = i + 1 < bands.size() ? bounds.removeFromLeft (bandWidth) : bounds;
+        bandBounds[i] = column.reduced (4, 0);
+
+        auto area = bandBounds[i].reduced (4);
+        area.removeFromTop (24);
+
+        auto buttons = area.removeFromBottom (28);
+        auto buttonWidth = buttons.getWidth() / 3;
+        band.bypass.setBounds (buttons.removeFromLeft (buttonWidth).reduced (2));
+        band.mute.setBounds (buttons.removeFromLeft (buttonWidth).reduced (2));
+        band.solo.setBounds (buttons.reduced (2));
+
+        auto top = area.removeFromTop (area.getHeight() / 2);
+        layoutKnob (band.threshold, forBand (Names::Threshold_Low_Band, i), top.removeFromLeft (top.getWidth() / 2));
+        layoutKnob (band.ratio, forBand (Names::Ratio_Low_Band, i), top);
+        layoutKnob (band.attack, forBand (Names::Attack_Low_Band, i), area.removeFromLeft (area.getWidth() / 2));
+        layoutKnob (band.release, forBand (Names::Release_Low_Band, i), area);
+    }
+
+    // Re-rendered at the right scale on the next paint().
+    background = {};
+}
+
+void SimpleMBCompAudioProcessorEditor::layoutKnob (juce::Slider& slider, Names name, juce::Rectangle<int> cell)
+{
+    labelBounds[(size_t) name] = cell.removeFromTop (16);
+    readoutBounds[(size_t) name] = cell.removeFromBottom (16);
+    slider.setBounds (cell.reduced (2));
+}
+
+void SimpleMBCompAudioProcessorEditor::renderBackground (float scale)
+{
+    if (getWidth() <= 0 || getHeight() <= 0)
+        return;
+
+    // Render at the display scale so the cached layer stays sharp on high-DPI screens.
+    backgroundScale = scale;
+    background = juce::Image (juce::Image::RGB,
+                              juce::roundToInt ((float) getWidth() * scale),
+                              juce::roundToInt ((float) getHeight() * scale),
+                              true);
+
+    juce::Graphics g (background);
+    g.addTransform (juce::AffineTransform::scale (scale));
+
+    auto backgroundColour = getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId);
+    g.fillAll (backgroundColour);
+
+    g.setColour (backgroundColour.brighter (0.1f));
+    g.fillRoundedRectangle (globalBounds.toFloat(), 6.0f);
+
+    for (auto& bandArea : bandBounds)
+        g.fillRoundedRectangle (bandArea.toFloat(), 6.0f);
+
+    g.setColour (juce::Colours::white);
+    g.setFont (18.0f);
+    g.drawFittedText ("SimpleMBComp", getLocalBounds().reduced (8).removeFromTop (28), juce::Justification::centredLeft, 1);
+
+    g.setFont (15.0f);
+
+    for (size_t i = 0; i < bandBounds.size(); ++i)
+        g.drawFittedText (bandTitles[i], bandBounds[i].reduced (4).removeFromTop (24), juce::Justification::centred, 1);
+
+    g.setColour (juce::Colours::lightgrey);
+    g.setFont (13.0f);
+
+    for (size_t i = 0; i < slidersByParam.size(); ++i)
+        if (slidersByParam[i] != nullptr)
+            g.drawFittedText (getKnobLabel ((Names) i), labelBounds[i], juce::Justification::centred, 1);
+}
+
+juce::String SimpleMBCompAudioProcessorEditor::getReadoutText (Names name) const
+{
+    return paramsByName[(size_t) name]->getCurrentValueAsText() + getUnitSuffix (name);
+}
+
+//==============================================================================
+void SimpleMBCompAudioProcessorEditor::parameterValueChanged (int parameterIndex, float)
+{
+    // May be called on the audio thread: only flag the readout and let the message thread catch up.
+    if (! juce::isPositiveAndBelow (parameterIndex, (int) nameForParameterIndex.size()))
+        return;
+
+    auto name = nameForParameterIndex[(size_t) parameterIndex];
+
+    if (name < 0)
+        return;
+
+    dirtyReadouts.fetch_or (1u << name);
+    triggerAsyncUpdate();
+}
+
+void SimpleMBCompAudioProcessorEditor::handleAsyncUpdate()
+{
+    const auto frameIntervalMs = (juce::uint32) (1000 / maxFramesPerSecond);
+    const auto elapsedMs = juce::Time::getMillisecondCounter() - lastFlushMs;
+
+    if (elapsedMs < frameIntervalMs)
+    {
+        if (! isTimerRunning())
+            startTimer ((int) (frameIntervalMs - elapsedMs));
+
+        return;
+    }
+
+    flushDirtyReadouts();
+}
+
+void SimpleMBCompAudioProcessorEditor::timerCallback()
+{
+    stopTimer();
+    flushDirtyReadouts();
+}
+
+void SimpleMBCompAudioProcessorEditor::flushDirtyReadouts()
+{
+    lastFlushMs = juce::Time::getMillisecondCounter();
+
+    auto dirty = dirtyReadouts.exchange (0);
+    juce::uint32 skipped = 0;
+
+    for (size_t i = 0; i < paramsByName.size(); ++i)
+    {
+        if ((dirty & (1u << i)) == 0)
+            continue;
+
+        auto value = paramsByName[i]->getValue();
+
+        if (auto* slider = slidersByParam[i])
+        {
+            // Don't pull a knob out from under the mouse. It stays dirty instead, and
+            // the flush that onDragEnd triggers moves it to wherever the parameter ended up.
+            if (slider->isMouseButtonDown())
+                skipped |= 1u << i;
+            else
+                slider->setValue (value, juce::dontSendNotification);
+
+            repaint (readoutBounds[i]);
+        }
+        else if (auto* button = buttonsByParam[i])
+        {
+            button->setToggleState (value >= 0.5f, juce::dontSendNotification);
+        }
+    }
+
+    if (skipped != 0)
+        dirtyReadouts.fetch_or (skipped);
 }
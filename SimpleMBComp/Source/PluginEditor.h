@@ -13,8 +13,21 @@
 
 //==============================================================================
 /**
+    Per-band editor. Everything static (panels, titles, knob labels) is drawn
+    once into a cached Image at the display scale; paint() only blits that
+    image and draws the value readouts that intersect the clip region, and
+    re-renders the image first if the size or the display scale changed.
+
+    Parameter changes, which may arrive on the audio thread, just mark their
+    parameter dirty. The dirty knobs, buttons and readouts are updated from an
+    AsyncUpdater, at most maxFramesPerSecond times a second. The controls are
+    wired to the parameters by hand rather than with APVTS attachments, which
+    would move and repaint a knob on every single parameter change.
 */
-class SimpleMBCompAudioProcessorEditor  : public juce::AudioProcessorEditor
+class SimpleMBCompAudioProcessorEditor  : public juce::AudioProcessorEditor,
+                                          private juce::AudioProcessorParameter::Listener,
+                                          private juce::AsyncUpdater,
+                                          private juce::Timer
 {
 public:
     SimpleMBCompAudioProcessorEditor (SimpleMBCompAudioProcessor&);
@@ -25,9 +38,55 @@ public:
     void resized() override;
 
 private:
+    using Names = Params::Names;
+
+    static constexpr int numParams = Names::Gain_Out + 1;
+    static constexpr int maxFramesPerSecond = 30;
+
+    struct BandControls
+    {
+        juce::Slider threshold, ratio, attack, release;
+        juce::TextButton bypass { "Bypass" }, mute { "Mute" }, solo { "Solo" };
+    };
+
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
     SimpleMBCompAudioProcessor& audioProcessor;
 
+    juce::Slider inputGain, lowMidCrossover, midHighCrossover, outputGain;
+    std::array<BandControls, 3> bands;
+
+    // Sliders run over the parameters' normalised 0..1 range.
+    std::array<juce::Slider*, numParams> slidersByParam {};
+    std::array<juce::Button*, numParams> buttonsByParam {};
+    std::array<juce::RangedAudioParameter*, numParams> paramsByName {};
+    std::array<juce::Rectangle<int>, numParams> labelBounds, readoutBounds;
+    std::array<juce::Rectangle<int>, 3> bandBounds;
+    juce::Rectangle<int> globalBounds;
+
+    // Maps AudioProcessorParameter::getParameterIndex() to a Names value, or -1.
+    std::vector<int> nameForParameterIndex;
+
+    // One bit per Names value.
+    std::atomic<juce::uint32> dirtyReadouts { 0 };
+    juce::uint32 lastFlushMs = 0;
+
+    juce::Image background;
+    float backgroundScale = 0.0f;
+
+    void attachSlider (juce::Slider&, Names);
+    void attachButton (juce::Button&, Names);
+
+    void listenTo (Names);
+    void layoutKnob (juce::Slider&, Names, juce::Rectangle<int> cell);
+    void renderBackground (float scale);
+    juce::String getReadoutText (Names) const;
+    void flushDirtyReadouts();
+
+    void parameterValueChanged (int parameterIndex, float newValue) override;
+    void parameterGestureChanged (int, bool) override {}
+    void handleAsyncUpdate() override;
+    void timerCallback() override;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SimpleMBCompAudioProcessorEditor)
 };
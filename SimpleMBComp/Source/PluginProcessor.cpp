@@ -122,14 +122,19 @@ int SimpleMBCompAudioProcessor::getNumPrograms() {
 
 int SimpleMBCompAudioProcessor::getCurrentProgram() { return 0; }
 
-void SimpleMBCompAudioProcessor::setCurrentProgram(int index) {}
+void SimpleMBCompAudioProcessor::setCurrentProgram(int index) {
+	juce::ignoreUnused(index);
+}
 
 const juce::String SimpleMBCompAudioProcessor::getProgramName(int index) {
+	juce::ignoreUnused(index);
 	return {};
 }
 
 void SimpleMBCompAudioProcessor::changeProgramName(
-	int index, const juce::String& newName) {}
+	int index, const juce::String& newName) {
+	juce::ignoreUnused(index, newName);
+}
 
 //==============================================================================
 void SimpleMBCompAudioProcessor::prepareToPlay(double sampleRate,
@@ -138,8 +143,8 @@ void SimpleMBCompAudioProcessor::prepareToPlay(double sampleRate,
 // initialisation that you need..
 	ProcessSpec spec;
 
-	spec.maximumBlockSize = samplesPerBlock;
-	spec.numChannels = getTotalNumOutputChannels();
+	spec.maximumBlockSize = static_cast<juce::uint32>(samplesPerBlock);
+	spec.numChannels = static_cast<juce::uint32>(getTotalNumOutputChannels());
 	spec.sampleRate = sampleRate;
 
 	for (auto& comp : compressors)
@@ -159,7 +164,7 @@ void SimpleMBCompAudioProcessor::prepareToPlay(double sampleRate,
 
 	for (auto& buffer : filterBuffers)
 	{
-		buffer.setSize(spec.numChannels, samplesPerBlock);
+		buffer.setSize(static_cast<int>(spec.numChannels), samplesPerBlock);
 	}
 }
 
@@ -214,9 +219,26 @@ void SimpleMBCompAudioProcessor::updateState()
 
 void SimpleMBCompAudioProcessor::splitBands(AudioBuffer<float>& buffer)
 {
+	SIMPLEMBCOMP_TRACE_SCOPE(tracer, Tracing::Event::SplitBands, buffer);
+
+	// AudioBuffer's copy-assignment reallocates whenever the block size differs from
+	// the last one, so resize within the storage reserved in prepareToPlay and copy.
+	auto copyBuffer = [](auto& dest, const auto& source)
+	{
+		auto nc = source.getNumChannels();
+		auto ns = source.getNumSamples();
+
+		dest.setSize(nc, ns, false, false, true);
+
+		for (auto i = 0; i < nc; ++i)
+		{
+			dest.copyFrom(i, 0, source, i, 0, ns);
+		}
+	};
+
 	for (auto& fb : filterBuffers)
 	{
-		fb = buffer;
+		copyBuffer(fb, buffer);
 	}
 
 	auto fb0Block = AudioBlock<float>(filterBuffers[0]);
@@ -230,13 +252,14 @@ void SimpleMBCompAudioProcessor::splitBands(AudioBuffer<float>& buffer)
 	LP1.process(fb0Ctx);
 	AP2.process(fb0Ctx);
 	HP1.process(fb1Ctx);
-	filterBuffers[2] = filterBuffers[1];
+	copyBuffer(filterBuffers[2], filterBuffers[1]);
 	LP2.process(fb1Ctx);
 	HP2.process(fb2Ctx);
 }
 
 void SimpleMBCompAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer,
 	juce::MidiBuffer& midiMessages) {
+	juce::ignoreUnused(midiMessages);
 	juce::ScopedNoDenormals noDenormals;
 	auto totalNumInputChannels = getTotalNumInputChannels();
 	auto totalNumOutputChannels = getTotalNumOutputChannels();
@@ -250,14 +273,29 @@ void SimpleMBCompAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer,
 	for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
 		buffer.clear(i, 0, buffer.getNumSamples());
 
-	updateState();
+	{
+		SIMPLEMBCOMP_TRACE_SCOPE(tracer, Tracing::Event::UpdateState, buffer);
+		updateState();
+	}
 
 	applyGain(buffer, inputGain);
 
 	splitBands(buffer);
 
 	for (size_t i = 0; i < filterBuffers.size(); ++i)
+	{
+		SIMPLEMBCOMP_TRACE_SCOPE(tracer, Tracing::compressEvent(i), filterBuffers[i]);
 		compressors[i].process(filterBuffers[i]);
+	}
+
+	sumBands(buffer);
+
+	applyGain(buffer, outputGain);
+}
+
+void SimpleMBCompAudioProcessor::sumBands(AudioBuffer<float>& buffer)
+{
+	SIMPLEMBCOMP_TRACE_SCOPE(tracer, Tracing::Event::SumBands, buffer);
 
 	auto numSamples = buffer.getNumSamples();
 	auto numChannels = buffer.getNumChannels();
@@ -303,7 +341,6 @@ void SimpleMBCompAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer,
 			}
 		}
 	}
-	applyGain(buffer, outputGain);
 }
 
 //==============================================================================
@@ -312,8 +349,7 @@ bool SimpleMBCompAudioProcessor::hasEditor() const {
 }
 
 juce::AudioProcessorEditor* SimpleMBCompAudioProcessor::createEditor() {
-  // return new SimpleMBCompAudioProcessorEditor(*this);
-	return new GenericAudioProcessorEditor(*this);
+	return new SimpleMBCompAudioProcessorEditor(*this);
 }
 
 //==============================================================================
@@ -331,7 +367,7 @@ void SimpleMBCompAudioProcessor::setStateInformation(const void* data,
 // You should use this method to restore your parameters from this memory
 // block, whose contents will have been created by the getStateInformation()
 // call.
-	auto tree = ValueTree::readFromData(data, sizeInBytes);
+	auto tree = ValueTree::readFromData(data, static_cast<size_t>(sizeInBytes));
 	if (tree.isValid())
 	{
 		apvts.replaceState(tree);
@@ -10,6 +10,9 @@
 
 #include <JuceHeader.h>
 
+#include "SharedDSP.h"
+#include "Tracing.h"
+
 using namespace juce;
 using namespace dsp;
 
@@ -126,7 +129,8 @@ struct CompressorBand
 		compressor.process(context);
 	}
 private:
-	Compressor<float> compressor;
+	// Attack/release coefficients are shared with every other instance at the same settings.
+	SharedCompressor compressor;
 
 };
 
@@ -186,7 +190,7 @@ private:
 	CompressorBand& lowBandComp = compressors[0];
 	CompressorBand& midBandComp = compressors[1];
 	CompressorBand& highBandComp = compressors[2];
-	using Filter = LinkwitzRileyFilter<float>;
+	using Filter = SharedLinkwitzRileyFilter;
 	//	   fc0  fc1
 	Filter LP1, AP2,
 		HP1, LP2,
@@ -212,6 +216,12 @@ private:
 	void updateState();
 
 	void splitBands(AudioBuffer<float>& buffer);
+
+	void sumBands(AudioBuffer<float>& buffer);
+
+#if SIMPLEMBCOMP_ENABLE_TRACING
+	Tracing::Tracer tracer;
+#endif
 	//==============================================================================
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SimpleMBCompAudioProcessor)
 };
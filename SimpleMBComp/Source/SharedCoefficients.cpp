@@ -0,0 +1,136 @@
+/*
+  ==============================================================================
+
+	Coefficient sets for the crossover filters and compressor ballistics, and a
+	process-wide cache so instances with the same settings share them.
+
+  ==============================================================================
+*/
+
+#include "SharedCoefficients.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+namespace SharedCoefficients
+{
+	namespace
+	{
+		constexpr double pi = 3.141592653589793238;
+
+		std::uint32_t floatBits(float value) noexcept
+		{
+			std::uint32_t bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+			return bits;
+		}
+
+		std::uint64_t makeKey(double sampleRate, float setting) noexcept
+		{
+			return (std::uint64_t(floatBits((float)sampleRate)) << 32) | floatBits(setting);
+		}
+
+		std::uint64_t hash(std::uint64_t key) noexcept
+		{
+			key ^= key >> 33;
+			key *= 0xff51afd7ed558ccdULL;
+			key ^= key >> 33;
+			key *= 0xc4ceb9fe1a85ec53ULL;
+			key ^= key >> 33;
+			return key;
+		}
+
+		/**
+			Fixed-size, insert-only open-addressing table. Slots go empty -> writing
+			-> ready exactly once; readers only trust a slot once it is ready, which
+			is published with release ordering after its key and value are written.
+			A slot another thread is still writing is skipped, which at worst stores
+			a duplicate entry further along the probe sequence.
+
+			The table lives in static storage and is constant-initialised, so
+			neither the first lookup nor any later one allocates or takes a lock.
+		*/
+		template<typename Coefficients, std::size_t capacity>
+		class Table
+		{
+		public:
+			const Coefficients* find(double sampleRate, float setting) noexcept
+			{
+				static_assert((capacity & (capacity - 1)) == 0, "capacity must be a power of two");
+
+				const auto key = makeKey(sampleRate, setting);
+				auto index = hash(key);
+
+				for (int probe = 0; probe < maxProbes; ++probe, ++index)
+				{
+					auto& slot = slots[index & (capacity - 1)];
+					auto state = slot.state.load(std::memory_order_acquire);
+
+					if (state == empty)
+					{
+						if (slot.state.compare_exchange_strong(state, writing, std::memory_order_acquire))
+						{
+							slot.key = key;
+							slot.coefficients = Coefficients::calculate(sampleRate, setting);
+							slot.state.store(ready, std::memory_order_release);
+							return &slot.coefficients;
+						}
+					}
+
+					if (state == ready && slot.key == key)
+						return &slot.coefficients;
+				}
+
+				return nullptr;
+			}
+
+		private:
+			static constexpr std::uint32_t empty = 0, writing = 1, ready = 2;
+			static constexpr int maxProbes = 32;
+
+			struct Slot
+			{
+				std::atomic<std::uint32_t> state{ empty };
+				std::uint64_t key{ 0 };
+				Coefficients coefficients;
+			};
+
+			Slot slots[capacity];
+		};
+
+		// Crossover settings snap to whole hertz (about 20k values per sample rate)
+		// and attack/release to whole milliseconds (496 values), so a full sweep of
+		// every setting at one sample rate fits before lookups start falling back.
+		Table<LinkwitzRiley, 32768> linkwitzRileyTable;
+		Table<Ballistics, 2048> ballisticsTable;
+	}
+
+	LinkwitzRiley LinkwitzRiley::calculate(double sampleRate, float cutoff) noexcept
+	{
+		LinkwitzRiley c;
+		c.g = (float)std::tan(pi * cutoff / sampleRate);
+		c.R2 = (float)std::sqrt(2.0);
+		c.h = (float)(1.0 / (1.0 + c.R2 * c.g + c.g * c.g));
+		return c;
+	}
+
+	Ballistics Ballistics::calculate(double sampleRate, float timeMs) noexcept
+	{
+		const auto expFactor = (float)(-2.0 * pi * 1000.0 / sampleRate);
+
+		Ballistics c;
+		c.cte = timeMs < 1.0e-3f ? 0.f : std::exp(expFactor / timeMs);
+		return c;
+	}
+
+	const LinkwitzRiley* findLinkwitzRiley(double sampleRate, float cutoff) noexcept
+	{
+		return linkwitzRileyTable.find(sampleRate, cutoff);
+	}
+
+	const Ballistics* findBallistics(double sampleRate, float timeMs) noexcept
+	{
+		return ballisticsTable.find(sampleRate, timeMs);
+	}
+}
@@ -0,0 +1,116 @@
+/*
+  ==============================================================================
+
+	Coefficient sets for the crossover filters and compressor ballistics, and a
+	process-wide cache so instances with the same settings share them.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+namespace SharedCoefficients
+{
+	/** One LR4 crossover stage. Same maths as juce::dsp::LinkwitzRileyFilter. */
+	struct LinkwitzRiley
+	{
+		float g{ 0 }, R2{ 0 }, h{ 0 };
+
+		static LinkwitzRiley calculate(double sampleRate, float cutoff) noexcept;
+	};
+
+	/** Peak ballistics smoothing constant. Same maths as juce::dsp::BallisticsFilter. */
+	struct Ballistics
+	{
+		float cte{ 0 };
+
+		static Ballistics calculate(double sampleRate, float timeMs) noexcept;
+	};
+
+	/**
+		Looks up (or computes and publishes) the coefficients for a setting at a
+		sample rate. Lookups are lock-free and never allocate, so they are safe
+		on the audio thread. Entries are never evicted, so the returned pointer
+		stays valid for the lifetime of the process and can be held by any
+		number of instances.
+
+		Returns nullptr if the table has no room left; callers then fall back to
+		a coefficient set of their own.
+	*/
+	const LinkwitzRiley* findLinkwitzRiley(double sampleRate, float cutoff) noexcept;
+	const Ballistics* findBallistics(double sampleRate, float timeMs) noexcept;
+
+	/**
+		True if the two settings are the same value. Settings are compared
+		exactly, without a tolerance: a cached set is only reused for the very
+		setting it was calculated for.
+	*/
+	template<typename Type>
+	bool isSameSetting(Type a, Type b) noexcept
+	{
+		return std::equal_to<Type>()(a, b);
+	}
+
+	/**
+		Holds a shared coefficient set, or a private one when the cache is full.
+
+		Copies are independent: a copy of a handle that holds a private set
+		points at its own copy of that set, never at the original's.
+	*/
+	template<typename Coefficients, const Coefficients* (*find)(double, float) noexcept>
+	class Handle
+	{
+	public:
+		Handle() = default;
+
+		Handle(const Handle& other) noexcept
+		{
+			*this = other;
+		}
+
+		Handle& operator=(const Handle& other) noexcept
+		{
+			fallback = other.fallback;
+			currentSampleRate = other.currentSampleRate;
+			currentSetting = other.currentSetting;
+			shared = other.shared == &other.fallback ? &fallback : other.shared;
+			return *this;
+		}
+
+		/** Returns true if the coefficients changed. */
+		bool set(double sampleRate, float setting) noexcept
+		{
+			if (shared != nullptr && isSameSetting(sampleRate, currentSampleRate) && isSameSetting(setting, currentSetting))
+				return false;
+
+			currentSampleRate = sampleRate;
+			currentSetting = setting;
+
+			shared = find(sampleRate, setting);
+
+			if (shared == nullptr)
+			{
+				fallback = Coefficients::calculate(sampleRate, setting);
+				shared = &fallback;
+			}
+
+			return true;
+		}
+
+		const Coefficients& get() const noexcept { return *shared; }
+		bool isValid() const noexcept { return shared != nullptr; }
+
+	private:
+		const Coefficients* shared{ nullptr };
+		Coefficients fallback;
+		double currentSampleRate{ 0 };
+		float currentSetting{ 0 };
+	};
+
+	using LinkwitzRileyHandle = Handle<LinkwitzRiley, findLinkwitzRiley>;
+	using BallisticsHandle = Handle<Ballistics, findBallistics>;
+}
@@ -0,0 +1,230 @@
+/*
+  ==============================================================================
+
+	Drop-in replacements for juce::dsp::LinkwitzRileyFilter and
+	juce::dsp::Compressor whose coefficients come from the process-wide
+	SharedCoefficients cache instead of being computed per instance.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "SharedCoefficients.h"
+
+//==============================================================================
+/**
+	LR4 filter with the same processing as juce::dsp::LinkwitzRileyFilter.
+*/
+class SharedLinkwitzRileyFilter
+{
+public:
+	void setType(juce::dsp::LinkwitzRileyFilterType newType) noexcept { type = newType; }
+
+	void setCutoffFrequency(float newCutoff) noexcept
+	{
+		cutoff = newCutoff;
+
+		if (sampleRate > 0)
+			coefficients.set(sampleRate, cutoff);
+	}
+
+	void prepare(const juce::dsp::ProcessSpec& spec)
+	{
+		jassert(spec.sampleRate > 0);
+		jassert(spec.numChannels > 0);
+
+		sampleRate = spec.sampleRate;
+
+		for (auto* state : { &s1, &s2, &s3, &s4 })
+			state->assign(spec.numChannels, 0.f);
+
+		coefficients.set(sampleRate, cutoff);
+	}
+
+	void reset() noexcept
+	{
+		for (auto* state : { &s1, &s2, &s3, &s4 })
+			std::fill(state->begin(), state->end(), 0.f);
+	}
+
+	template<typename ProcessContext>
+	void process(const ProcessContext& context) noexcept
+	{
+		const auto& inputBlock = context.getInputBlock();
+		auto& outputBlock = context.getOutputBlock();
+		const auto numChannels = outputBlock.getNumChannels();
+		const auto numSamples = outputBlock.getNumSamples();
+
+		jassert(inputBlock.getNumChannels() <= s1.size());
+		jassert(inputBlock.getNumChannels() == numChannels);
+		jassert(inputBlock.getNumSamples() == numSamples);
+
+		if (context.isBypassed)
+		{
+			if (context.usesSeparateInputAndOutputBlocks())
+				outputBlock.copyFrom(inputBlock);
+
+			return;
+		}
+
+		const auto& c = coefficients.get();
+
+		for (size_t channel = 0; channel < numChannels; ++channel)
+		{
+			auto* inputSamples = inputBlock.getChannelPointer(channel);
+			auto* outputSamples = outputBlock.getChannelPointer(channel);
+
+			for (size_t i = 0; i < numSamples; ++i)
+				outputSamples[i] = processSample(c, channel, inputSamples[i]);
+		}
+
+		for (auto* state : { &s1, &s2, &s3, &s4 })
+			for (auto& element : *state)
+				juce::dsp::util::snapToZero(element);
+	}
+
+private:
+	juce::dsp::LinkwitzRileyFilterType type{ juce::dsp::LinkwitzRileyFilterType::lowpass };
+	float cutoff{ 2000.f };
+	double sampleRate{ 0 };
+
+	SharedCoefficients::LinkwitzRileyHandle coefficients;
+	std::vector<float> s1, s2, s3, s4;
+
+	float processSample(const SharedCoefficients::LinkwitzRiley& c, size_t channel, float inputValue) noexcept
+	{
+		auto yH = (inputValue - (c.R2 + c.g) * s1[channel] - s2[channel]) * c.h;
+
+		auto yB = c.g * yH + s1[channel];
+		s1[channel] = c.g * yH + yB;
+
+		auto yL = c.g * yB + s2[channel];
+		s2[channel] = c.g * yB + yL;
+
+		if (type == juce::dsp::LinkwitzRileyFilterType::allpass)
+			return yL - c.R2 * yB + yH;
+
+		auto yH2 = ((type == juce::dsp::LinkwitzRileyFilterType::lowpass ? yL : yH) - (c.R2 + c.g) * s3[channel] - s4[channel]) * c.h;
+
+		auto yB2 = c.g * yH2 + s3[channel];
+		s3[channel] = c.g * yH2 + yB2;
+
+		auto yL2 = c.g * yB2 + s4[channel];
+		s4[channel] = c.g * yB2 + yL2;
+
+		return type == juce::dsp::LinkwitzRileyFilterType::lowpass ? yL2 : yH2;
+	}
+};
+
+//==============================================================================
+/**
+	Peak compressor with the same processing as juce::dsp::Compressor.
+*/
+class SharedCompressor
+{
+public:
+	void setAttack(float newAttackMs) noexcept
+	{
+		attackMs = newAttackMs;
+
+		if (sampleRate > 0)
+			attack.set(sampleRate, attackMs);
+	}
+
+	void setRelease(float newReleaseMs) noexcept
+	{
+		releaseMs = newReleaseMs;
+
+		if (sampleRate > 0)
+			release.set(sampleRate, releaseMs);
+	}
+
+	void setThreshold(float newThresholdDb) noexcept
+	{
+		if (SharedCoefficients::isSameSetting(newThresholdDb, thresholdDb))
+			return;
+
+		thresholdDb = newThresholdDb;
+		threshold = juce::Decibels::decibelsToGain(thresholdDb, -200.f);
+		thresholdInverse = 1.f / threshold;
+	}
+
+	void setRatio(float newRatio) noexcept
+	{
+		jassert(newRatio >= 1.f);
+
+		ratio = newRatio;
+		ratioInverse = 1.f / ratio;
+	}
+
+	void prepare(const juce::dsp::ProcessSpec& spec)
+	{
+		jassert(spec.sampleRate > 0);
+		jassert(spec.numChannels > 0);
+
+		sampleRate = spec.sampleRate;
+		envelope.assign(spec.numChannels, 0.f);
+
+		attack.set(sampleRate, attackMs);
+		release.set(sampleRate, releaseMs);
+	}
+
+	void reset() noexcept
+	{
+		std::fill(envelope.begin(), envelope.end(), 0.f);
+	}
+
+	template<typename ProcessContext>
+	void process(const ProcessContext& context) noexcept
+	{
+		const auto& inputBlock = context.getInputBlock();
+		auto& outputBlock = context.getOutputBlock();
+		const auto numChannels = outputBlock.getNumChannels();
+		const auto numSamples = outputBlock.getNumSamples();
+
+		jassert(inputBlock.getNumChannels() == numChannels);
+		jassert(inputBlock.getNumSamples() == numSamples);
+
+		if (context.isBypassed)
+		{
+			if (context.usesSeparateInputAndOutputBlocks())
+				outputBlock.copyFrom(inputBlock);
+
+			return;
+		}
+
+		const auto cteAT = attack.get().cte;
+		const auto cteRL = release.get().cte;
+
+		for (size_t channel = 0; channel < numChannels; ++channel)
+		{
+			auto* inputSamples = inputBlock.getChannelPointer(channel);
+			auto* outputSamples = outputBlock.getChannelPointer(channel);
+			auto& yold = envelope[channel];
+
+			for (size_t i = 0; i < numSamples; ++i)
+			{
+				auto x = inputSamples[i];
+				auto level = std::abs(x);
+				auto cte = level > yold ? cteAT : cteRL;
+				auto env = level + cte * (yold - level);
+				yold = env;
+
+				auto gain = env < threshold ? 1.f : std::pow(env * thresholdInverse, ratioInverse - 1.f);
+				outputSamples[i] = gain * x;
+			}
+		}
+	}
+
+private:
+	double sampleRate{ 0 };
+	float attackMs{ 1.f }, releaseMs{ 100.f };
+	float thresholdDb{ 0.f }, ratio{ 1.f };
+	float threshold{ 1.f }, thresholdInverse{ 1.f }, ratioInverse{ 1.f };
+
+	SharedCoefficients::BallisticsHandle attack, release;
+	std::vector<float> envelope;
+};
@@ -0,0 +1,296 @@
+/*
+  ==============================================================================
+
+	Optional hot-path instrumentation for processBlock.
+
+  ==============================================================================
+*/
+
+#include "Tracing.h"
+
+#if SIMPLEMBCOMP_ENABLE_TRACING
+
+using namespace juce;
+
+namespace Tracing
+{
+	namespace
+	{
+		const char* getEventName(Event event)
+		{
+			switch (event)
+			{
+			case Event::UpdateState:      return "updateState";
+			case Event::SplitBands:       return "splitBands";
+			case Event::CompressLowBand:  return "compress low band";
+			case Event::CompressMidBand:  return "compress mid band";
+			case Event::CompressHighBand: return "compress high band";
+			case Event::SumBands:         return "sumBands";
+			case Event::NumEvents:        break;
+			}
+
+			jassertfalse;
+			return "unknown";
+		}
+
+		double ticksToMicroseconds(int64 ticks)
+		{
+			return (double)ticks * 1.0e6 / (double)Time::getHighResolutionTicksPerSecond();
+		}
+
+		int getNextInstanceId()
+		{
+			static std::atomic<int> nextId{ 1 };
+			return nextId.fetch_add(1);
+		}
+
+		File getPreviousTraceFile(const File& traceFile)
+		{
+			return traceFile.getSiblingFile(traceFile.getFileNameWithoutExtension() + "-previous.json");
+		}
+
+		/**
+			Creates this instance's summary file straight away. Other processes (a
+			second host, a plugin scanner) number their instances from 1 as well and
+			write to the same directory, so the name also has a random part, and none
+			of the files the tracer may write are allowed to exist already.
+		*/
+		File createSummaryFile(int instanceId)
+		{
+			const auto directory = File::getSpecialLocation(File::tempDirectory);
+
+			for (int attempt = 0; attempt < 100; ++attempt)
+			{
+				auto file = directory.getChildFile("SimpleMBComp-trace-"
+					+ String::toHexString(Random::getSystemRandom().nextInt64())
+					+ "-" + String(instanceId) + ".txt");
+
+				const auto traceFile = file.withFileExtension("json");
+
+				if (file.exists() || traceFile.exists() || getPreviousTraceFile(traceFile).exists())
+					continue;
+
+				if (file.create())
+					return file;
+			}
+
+			// The temp directory is not writable: trace without writing anything.
+			jassertfalse;
+			return {};
+		}
+	}
+
+	//==============================================================================
+	/**
+		The one thread that drains every Tracer in the process. Tracers add and
+		remove themselves on the message thread; the lock is never taken on the
+		audio thread, where push() only touches the tracer's own fifo.
+	*/
+	class DrainThread : private Thread
+	{
+	public:
+		DrainThread() : Thread("SimpleMBComp tracer")
+		{
+			startThread(Priority::low);
+		}
+
+		~DrainThread() override
+		{
+			stopThread(1000);
+		}
+
+		/** The running thread, started by the first tracer and stopped after the last one. */
+		static std::shared_ptr<DrainThread> getInstance()
+		{
+			static CriticalSection instanceLock;
+			static std::weak_ptr<DrainThread> instance;
+
+			const ScopedLock sl(instanceLock);
+			auto thread = instance.lock();
+
+			if (thread == nullptr)
+			{
+				thread = std::make_shared<DrainThread>();
+				instance = thread;
+			}
+
+			return thread;
+		}
+
+		void add(Tracer* tracer)
+		{
+			const ScopedLock sl(lock);
+			tracers.add(tracer);
+		}
+
+		/** Once this returns, the thread is not servicing the tracer and never will again. */
+		void remove(Tracer* tracer)
+		{
+			const ScopedLock sl(lock);
+			tracers.removeFirstMatchingValue(tracer);
+		}
+
+	private:
+		CriticalSection lock;
+		Array<Tracer*> tracers;
+
+		void run() override
+		{
+			while (!threadShouldExit())
+			{
+				{
+					const ScopedLock sl(lock);
+
+					for (auto* tracer : tracers)
+						tracer->service();
+				}
+
+				wait(50);
+			}
+		}
+	};
+
+	//==============================================================================
+	Tracer::Tracer()
+		: instanceId(getNextInstanceId()),
+		startTicks(Time::getHighResolutionTicks()),
+		lastSummaryMs(Time::getMillisecondCounter())
+	{
+		summaryFile = createSummaryFile(instanceId);
+
+#if SIMPLEMBCOMP_TRACING_WRITE_EVENTS
+		if (summaryFile != File())
+		{
+			traceFile = summaryFile.withFileExtension("json");
+			openTraceFile();
+		}
+#endif
+
+		drainThread = DrainThread::getInstance();
+		drainThread->add(this);
+	}
+
+	Tracer::~Tracer()
+	{
+		drainThread->remove(this);
+
+		drain();
+		closeTraceFile();
+		writeSummary();
+	}
+
+	void Tracer::service()
+	{
+		drain();
+
+		// Keep what has been measured so far on disk in case the host crashes.
+		if (Time::getMillisecondCounter() - lastSummaryMs >= (uint32)summaryIntervalMs)
+		{
+			lastSummaryMs = Time::getMillisecondCounter();
+
+			if (traceStream != nullptr)
+				traceStream->flush();
+
+			writeSummary();
+		}
+	}
+
+	void Tracer::openTraceFile()
+	{
+		traceStream = std::make_unique<FileOutputStream>(traceFile);
+
+		if (traceStream->failedToOpen())
+		{
+			jassertfalse;
+			traceStream.reset();
+			return;
+		}
+
+		// Viewers accept the array without its closing bracket, so the file
+		// stays readable if the host crashes before closeTraceFile().
+		*traceStream << "[\n";
+		isFirstEvent = true;
+	}
+
+	void Tracer::closeTraceFile()
+	{
+		if (traceStream == nullptr)
+			return;
+
+		*traceStream << "\n]\n";
+		traceStream.reset();
+	}
+
+	void Tracer::rotateTraceFile()
+	{
+		closeTraceFile();
+
+		// Both files are this tracer's own, so they can be replaced. If the move
+		// fails, start the current file afresh rather than appending to it.
+		if (!traceFile.moveFileTo(getPreviousTraceFile(traceFile)))
+			traceFile.deleteFile();
+
+		openTraceFile();
+	}
+
+	void Tracer::drain()
+	{
+		const auto scope = fifo.read(fifo.getNumReady());
+
+		scope.forEach([this](int index)
+		{
+			const auto& record = records[(size_t)index];
+			const auto duration = record.end - record.start;
+
+			auto& s = stats[(size_t)record.event];
+			++s.count;
+			s.totalTicks += duration;
+			s.maxTicks = jmax(s.maxTicks, duration);
+
+			if (traceStream == nullptr)
+				return;
+
+			if (!isFirstEvent)
+				*traceStream << ",\n";
+
+			isFirstEvent = false;
+
+			*traceStream << "{\"name\":\"" << getEventName(record.event)
+				<< "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << instanceId
+				<< ",\"ts\":" << String(ticksToMicroseconds(record.start - startTicks), 3)
+				<< ",\"dur\":" << String(ticksToMicroseconds(duration), 3)
+				<< ",\"args\":{\"samples\":" << record.numSamples
+				<< ",\"channels\":" << (int)record.numChannels << "}}";
+
+			if (traceStream->getPosition() >= maxEventFileBytes)
+				rotateTraceFile();
+		});
+	}
+
+	void Tracer::writeSummary()
+	{
+		String summary;
+		summary << "SimpleMBComp trace summary, instance " << instanceId << "\n\n";
+
+		for (size_t i = 0; i < stats.size(); ++i)
+		{
+			const auto& s = stats[i];
+			if (s.count == 0)
+				continue;
+
+			summary << String(getEventName((Event)i)).paddedRight(' ', 20)
+				<< " count " << String(s.count).paddedLeft(' ', 10)
+				<< "  mean " << String(ticksToMicroseconds(s.totalTicks) / (double)s.count, 2).paddedLeft(' ', 10) << " us"
+				<< "  max " << String(ticksToMicroseconds(s.maxTicks), 2).paddedLeft(' ', 10) << " us\n";
+		}
+
+		summary << "\ndropped records: " << (int)numDropped.load() << "\n";
+
+		// replaceWithText writes a temporary file and swaps it in, so a crash
+		// mid-write leaves the previous summary intact.
+		if (summaryFile != File())
+			summaryFile.replaceWithText(summary);
+	}
+}
+
+#endif
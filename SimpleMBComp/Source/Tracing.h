@@ -0,0 +1,172 @@
+/*
+  ==============================================================================
+
+	Optional hot-path instrumentation for processBlock.
+
+	Build with SIMPLEMBCOMP_ENABLE_TRACING=1 to record a timing record for
+	every traced scope. Records go into a per-instance wait-free ring buffer.
+	One background thread, shared by every instance in the process, drains
+	them into per-scope statistics, which it writes to a small summary file
+	per instance in the temp directory every few seconds and once more when
+	the instance is destroyed.
+
+	Also define SIMPLEMBCOMP_TRACING_WRITE_EVENTS=1 to write every record to
+	a Chrome/Perfetto trace next to the summary (chrome://tracing,
+	ui.perfetto.dev). That file is rotated at
+	SIMPLEMBCOMP_TRACING_MAX_EVENT_FILE_MB, keeping the current file and the
+	one before it, so a long session cannot fill the disk.
+
+	With tracing disabled the macros below expand to nothing.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#ifndef SIMPLEMBCOMP_ENABLE_TRACING
+ #define SIMPLEMBCOMP_ENABLE_TRACING 0
+#endif
+
+#ifndef SIMPLEMBCOMP_TRACING_WRITE_EVENTS
+ #define SIMPLEMBCOMP_TRACING_WRITE_EVENTS 0
+#endif
+
+#ifndef SIMPLEMBCOMP_TRACING_MAX_EVENT_FILE_MB
+ #define SIMPLEMBCOMP_TRACING_MAX_EVENT_FILE_MB 64
+#endif
+
+#if SIMPLEMBCOMP_ENABLE_TRACING
+
+namespace Tracing
+{
+	enum class Event : juce::uint16
+	{
+		UpdateState,
+		SplitBands,
+		CompressLowBand,
+		CompressMidBand,
+		CompressHighBand,
+		SumBands,
+
+		NumEvents
+	};
+
+	inline Event compressEvent(size_t bandIndex)
+	{
+		return static_cast<Event>(static_cast<size_t>(Event::CompressLowBand) + bandIndex);
+	}
+
+	struct Record
+	{
+		juce::int64 start;
+		juce::int64 end;
+		juce::int32 numSamples;
+		juce::int16 numChannels;
+		Event event;
+	};
+
+	class DrainThread;
+
+	//==============================================================================
+	/**
+		Collects Records from the audio thread; the shared DrainThread writes
+		them out. push() must only be called from one thread at a time, which
+		processBlock guarantees.
+	*/
+	class Tracer
+	{
+	public:
+		Tracer();
+		~Tracer();
+
+		/** Wait-free. Drops the record if the drain thread has fallen behind. */
+		void push(const Record& record) noexcept
+		{
+			int start1, size1, start2, size2;
+			fifo.prepareToWrite(1, start1, size1, start2, size2);
+
+			if (size1 + size2 == 0)
+			{
+				numDropped.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+
+			records[(size_t)(size1 > 0 ? start1 : start2)] = record;
+			fifo.finishedWrite(1);
+		}
+
+	private:
+		static constexpr int capacity = 4096;
+		static constexpr int summaryIntervalMs = 5000;
+		static constexpr juce::int64 maxEventFileBytes = (juce::int64)SIMPLEMBCOMP_TRACING_MAX_EVENT_FILE_MB << 20;
+
+		juce::AbstractFifo fifo{ capacity };
+		std::array<Record, capacity> records;
+		std::atomic<juce::uint32> numDropped{ 0 };
+
+		struct Stats
+		{
+			juce::int64 count{ 0 };
+			juce::int64 totalTicks{ 0 };
+			juce::int64 maxTicks{ 0 };
+		};
+
+		std::array<Stats, (size_t)Event::NumEvents> stats;
+
+		const int instanceId;
+		const juce::int64 startTicks;
+		juce::File summaryFile, traceFile;
+		std::unique_ptr<juce::FileOutputStream> traceStream;
+		bool isFirstEvent{ true };
+		juce::uint32 lastSummaryMs;
+
+		std::shared_ptr<DrainThread> drainThread;
+		friend class DrainThread;
+
+		void service();
+		void drain();
+		void writeSummary();
+		void openTraceFile();
+		void closeTraceFile();
+		void rotateTraceFile();
+
+		JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Tracer)
+	};
+
+	//==============================================================================
+	class ScopedTrace
+	{
+	public:
+		ScopedTrace(Tracer& t, Event event, const juce::AudioBuffer<float>& buffer) noexcept
+			: tracer(t)
+		{
+			record.event = event;
+			record.numSamples = buffer.getNumSamples();
+			record.numChannels = (juce::int16)buffer.getNumChannels();
+			record.start = juce::Time::getHighResolutionTicks();
+		}
+
+		~ScopedTrace() noexcept
+		{
+			record.end = juce::Time::getHighResolutionTicks();
+			tracer.push(record);
+		}
+
+	private:
+		Tracer& tracer;
+		Record record;
+
+		JUCE_DECLARE_NON_COPYABLE(ScopedTrace)
+	};
+}
+
+ #define SIMPLEMBCOMP_TRACE_SCOPE(tracer, event, buffer) \
+	const Tracing::ScopedTrace JUCE_JOIN_MACRO(traceScope_, __LINE__)(tracer, event, buffer)
+
+#else
+
+ #define SIMPLEMBCOMP_TRACE_SCOPE(tracer, event, buffer)
+
+#endif
@@ -0,0 +1,254 @@
+/*
+  ==============================================================================
+
+	MultiStemProcessor against N separate mono SimpleMBCompAudioProcessors.
+
+  ==============================================================================
+*/
+
+#include "MultiStemProcessor.h"
+#include "TestHelpers.h"
+
+using namespace TestHelpers;
+
+namespace
+{
+	constexpr double sampleRate = 44100;
+	constexpr int maximumBlockSize = 512;
+
+	// More than one register's worth and not a multiple of the lane width,
+	// so the padded lanes are exercised too.
+	constexpr int numStems = 11;
+
+	struct Scenario
+	{
+		String name;
+		Settings initial;
+		std::optional<Settings> changed;	// applied halfway through, to both sides
+		std::vector<int> blockSizes;
+		std::vector<int> processorBlockSizes;	// what the processors see for the same audio
+	};
+
+	std::vector<AudioBuffer<float>> makeStems(int numSamples)
+	{
+		std::vector<AudioBuffer<float>> stems;
+
+		for (int i = 0; i < numStems; ++i)
+		{
+			stems.push_back(makeTestSignal(1, numSamples, sampleRate, 100 + i));
+			stems.back().applyGain(0.25f + 0.15f * (float)i);
+		}
+
+		return stems;
+	}
+
+	template<typename ProcessFunction>
+	void processScenarioBlocks(const Scenario& scenario, const std::vector<int>& blockSizes, int numSamples,
+		AudioProcessorValueTreeState& apvts, ProcessFunction&& process)
+	{
+		applySettings(scenario.initial, apvts);
+
+		auto isChanged = false;
+		size_t blockIndex = 0;
+
+		for (int start = 0; start < numSamples; )
+		{
+			if (scenario.changed.has_value() && !isChanged && start >= numSamples / 2)
+			{
+				applySettings(*scenario.changed, apvts);
+				isChanged = true;
+			}
+
+			auto blockSize = jmin(blockSizes[blockIndex++ % blockSizes.size()], numSamples - start);
+			process(start, blockSize);
+			start += blockSize;
+		}
+	}
+
+	Settings compressingSettings()
+	{
+		Settings settings;
+		settings.lowMidCrossover = 300;
+		settings.midHighCrossover = 4000;
+		settings.inputGain = 6;
+		settings.outputGain = -3;
+
+		const std::array<float, 3> thresholds{ -30, -24, -18 };
+		const std::array<float, 3> ratios{ 4, 8, 20 };
+		const std::array<float, 3> attacks{ 5, 20, 50 };
+		const std::array<float, 3> releases{ 50, 150, 400 };
+
+		for (size_t i = 0; i < settings.bands.size(); ++i)
+		{
+			settings.bands[i].threshold = thresholds[i];
+			settings.bands[i].ratio = ratios[i];
+			settings.bands[i].attack = attacks[i];
+			settings.bands[i].release = releases[i];
+		}
+
+		return settings;
+	}
+}
+
+//==============================================================================
+class MultiStemProcessorTests : public UnitTest
+{
+public:
+	MultiStemProcessorTests() : UnitTest("Multi-stem processor", "SimpleMBComp") {}
+
+	void runTest() override
+	{
+		for (auto allowAVX2 : { false, true })
+			for (const auto& scenario : makeScenarios())
+				testScenario(scenario, allowAVX2);
+
+		testTooManyStems();
+	}
+
+private:
+	static std::vector<Scenario> makeScenarios()
+	{
+		const auto& varying = getVaryingBlockSizes();
+		std::vector<Scenario> scenarios;
+
+		// The gains ramp up from silence over the first 50 ms on both sides.
+		scenarios.push_back({ "compressing", compressingSettings(), {}, varying, varying });
+
+		{
+			auto settings = compressingSettings();
+			settings.bands[0].isBypassed = true;
+			settings.bands[1].isBypassed = true;
+			scenarios.push_back({ "bypassed bands", settings, {}, varying, varying });
+		}
+
+		{
+			auto muted = compressingSettings();
+			muted.bands[1].isMuted = true;
+			scenarios.push_back({ "muted mid band", muted, {}, varying, varying });
+
+			auto soloed = compressingSettings();
+			soloed.bands[2].isSoloed = true;
+			soloed.bands[0].isMuted = true;
+			scenarios.push_back({ "soloed high band", soloed, {}, varying, varying });
+
+			auto soloedAndMuted = compressingSettings();
+			soloedAndMuted.bands[0].isSoloed = true;
+			soloedAndMuted.bands[0].isMuted = true;
+			scenarios.push_back({ "soloed and muted low band", soloedAndMuted, {}, varying, varying });
+
+			auto allMuted = compressingSettings();
+
+			for (auto& band : allMuted.bands)
+				band.isMuted = true;
+
+			scenarios.push_back({ "every band muted", allMuted, {}, varying, varying });
+		}
+
+		{
+			// Halfway through, the gains ramp to new targets over 50 ms while the
+			// crossovers, thresholds and routing change as well.
+			auto changed = compressingSettings();
+			changed.inputGain = -12;
+			changed.outputGain = 9;
+			changed.lowMidCrossover = 800;
+			changed.midHighCrossover = 2500;
+			changed.bands[1].threshold = -6;
+			changed.bands[2].isBypassed = true;
+			changed.bands[0].isSoloed = true;
+			changed.bands[1].isSoloed = true;
+
+			scenarios.push_back({ "settings and gain ramp mid-stream", compressingSettings(), changed, varying, varying });
+		}
+
+		// Longer than the prepared maximum: processed in chunks of that size.
+		scenarios.push_back({ "blocks longer than the prepared maximum", compressingSettings(), {},
+			{ 1300, 2048, 7 }, { 512, 512, 276, 512, 512, 512, 512, 7 } });
+
+		return scenarios;
+	}
+
+	void testScenario(const Scenario& scenario, bool allowAVX2)
+	{
+		beginTest(scenario.name + (allowAVX2 ? " (AVX2 if available)" : " (scalar)"));
+
+		const auto numSamples = (int)sampleRate / 4;
+		auto expected = makeStems(numSamples);
+		auto actual = makeStems(numSamples);
+
+		for (auto& stem : expected)
+		{
+			PreparedProcessor prepared(sampleRate, maximumBlockSize, 1);
+
+			processScenarioBlocks(scenario, scenario.processorBlockSizes, numSamples, prepared.processor.apvts,
+				[&](int start, int blockSize)
+				{
+					AudioBuffer<float> block(stem.getArrayOfWritePointers(), 1, start, blockSize);
+					prepared.processor.processBlock(block, prepared.midi);
+				});
+		}
+
+		SimpleMBCompAudioProcessor controller;
+		MultiStemProcessor multiStem(controller.apvts);
+		multiStem.prepare(sampleRate, maximumBlockSize, numStems, allowAVX2);
+
+		if (allowAVX2)
+			logMessage(multiStem.isUsingAVX2() ? "Using the AVX2 kernels" : "AVX2 not available: using the scalar kernels");
+		else
+			expect(!multiStem.isUsingAVX2());
+
+		std::array<float*, numStems> pointers;
+
+		processScenarioBlocks(scenario, scenario.blockSizes, numSamples, controller.apvts,
+			[&](int start, int blockSize)
+			{
+				for (int i = 0; i < numStems; ++i)
+					pointers[(size_t)i] = actual[(size_t)i].getWritePointer(0, start);
+
+				expect(multiStem.process(pointers.data(), numStems, blockSize));
+			});
+
+		float worst = 0;
+
+		for (int i = 0; i < numStems; ++i)
+			worst = jmax(worst, maxAbsDifference(actual[(size_t)i], expected[(size_t)i]));
+
+		expectLessThan(worst, 1.0e-4f, "against " + String(numStems) + " mono processors");
+	}
+
+	void testTooManyStems()
+	{
+		beginTest("More stems than prepared for are refused, not partly processed");
+
+		// Each refusal below also logs a jassert in debug builds; that is expected.
+
+		SimpleMBCompAudioProcessor controller;
+		MultiStemProcessor multiStem(controller.apvts);
+
+		const auto numSamples = maximumBlockSize;
+		auto stems = makeStems(numSamples);
+		const auto original = makeStems(numSamples);
+
+		std::array<float*, numStems> pointers;
+
+		for (size_t i = 0; i < stems.size(); ++i)
+			pointers[i] = stems[i].getWritePointer(0);
+
+		expect(!multiStem.process(pointers.data(), numStems, numSamples), "before prepare()");
+
+		// Padded to 8 lanes, but only 7 stems were asked for.
+		constexpr int numPreparedStems = numStems - 4;
+		multiStem.prepare(sampleRate, maximumBlockSize, numPreparedStems);
+		expect(!multiStem.process(pointers.data(), numStems, numSamples), "more stems than prepared for");
+
+		float worst = 0;
+
+		for (size_t i = 0; i < stems.size(); ++i)
+			worst = jmax(worst, maxAbsDifference(stems[i], original[i]));
+
+		expectLessOrEqual(worst, 0.f, "a refused call leaves every stem untouched");
+
+		expect(multiStem.process(pointers.data(), numPreparedStems, numSamples), "as many stems as prepared for");
+	}
+};
+
+static MultiStemProcessorTests multiStemProcessorTests;
@@ -0,0 +1,288 @@
+/*
+  ==============================================================================
+
+	Output tests for SimpleMBCompAudioProcessor: golden output against the
+	stock juce::dsp chain, the crossover null test and mute/solo routing.
+
+  ==============================================================================
+*/
+
+#include "TestHelpers.h"
+
+using namespace TestHelpers;
+
+namespace
+{
+	constexpr double sampleRate = 44100;
+	constexpr int maximumBlockSize = 512;
+	constexpr int numChannels = 2;
+
+	// Longer than the 50 ms gain ramp, which starts from silence after prepareToPlay.
+	constexpr int warmUpSamples = 4096;
+
+	Settings linearSettings(float lowMidCrossover, float midHighCrossover)
+	{
+		Settings settings;
+		settings.lowMidCrossover = lowMidCrossover;
+		settings.midHighCrossover = midHighCrossover;
+
+		for (auto& band : settings.bands)
+			band.isBypassed = true;
+
+		return settings;
+	}
+
+	/** Silence followed by the test signal. */
+	AudioBuffer<float> makeSignalAfterWarmUp(int numSamples, int seed)
+	{
+		auto signal = makeTestSignal(numChannels, numSamples, sampleRate, seed);
+
+		AudioBuffer<float> buffer(numChannels, warmUpSamples + numSamples);
+		buffer.clear();
+
+		for (int ch = 0; ch < numChannels; ++ch)
+			buffer.copyFrom(ch, warmUpSamples, signal, ch, 0, numSamples);
+
+		return buffer;
+	}
+
+	AudioBuffer<float> processWithSettings(const Settings& settings, const AudioBuffer<float>& input)
+	{
+		PreparedProcessor prepared(sampleRate, maximumBlockSize, numChannels);
+		applySettings(settings, prepared.processor.apvts);
+
+		AudioBuffer<float> output(input);
+		prepared.process(output, getVaryingBlockSizes());
+		return output;
+	}
+}
+
+//==============================================================================
+class ProcessorOutputTests : public UnitTest
+{
+public:
+	ProcessorOutputTests() : UnitTest("Processor output", "SimpleMBComp") {}
+
+	void runTest() override
+	{
+		testGoldenOutput();
+		testCrossoverNull();
+		testMuteSoloRouting();
+	}
+
+private:
+	void testGoldenOutput()
+	{
+		beginTest("Golden output over a parameter grid");
+
+		const auto input = makeTestSignal(numChannels, (int)sampleRate / 4, sampleRate, 1);
+
+		const std::array<std::pair<float, float>, 3> crossovers{ { { 100, 1500 }, { 600, 3500 }, { 950, 16000 } } };
+		const std::array<float, 3> thresholds{ -30, -6, 6 };
+		const std::array<float, 3> ratios{ 1, 4, 50 };
+		const std::array<std::pair<float, float>, 2> times{ { { 5, 50 }, { 200, 500 } } };
+		const std::array<std::pair<float, float>, 2> gains{ { { 0, 0 }, { -6, 9 } } };
+
+		float worst = 0;
+		int numRuns = 0;
+
+		for (auto [lowMid, midHigh] : crossovers)
+			for (auto threshold : thresholds)
+				for (auto ratio : ratios)
+					for (auto [attack, release] : times)
+						for (auto [gainIn, gainOut] : gains)
+						{
+							Settings settings;
+							settings.lowMidCrossover = lowMid;
+							settings.midHighCrossover = midHigh;
+							settings.inputGain = gainIn;
+							settings.outputGain = gainOut;
+
+							// Stagger the bands so each one sees different settings.
+							for (size_t i = 0; i < settings.bands.size(); ++i)
+							{
+								auto& band = settings.bands[i];
+								band.threshold = threshold - 6.f * (float)i;
+								band.ratio = ratio;
+								band.attack = attack * (float)(i + 1);
+								band.release = release;
+								band.isBypassed = (numRuns + (int)i) % 5 == 0;
+							}
+
+							PreparedProcessor prepared(sampleRate, maximumBlockSize, numChannels);
+							applySettings(settings, prepared.processor.apvts);
+
+							AudioBuffer<float> actual(input);
+							prepared.process(actual, getVaryingBlockSizes());
+
+							ReferenceChain reference(sampleRate, maximumBlockSize, numChannels);
+							AudioBuffer<float> expected(input);
+							reference.process(expected, readSettings(prepared.processor.apvts), getVaryingBlockSizes());
+
+							auto difference = maxAbsDifference(actual, expected);
+							worst = jmax(worst, difference);
+
+							if (difference > 1.0e-5f)
+								logMessage("Mismatch at crossovers " + String(lowMid) + "/" + String(midHigh)
+									+ " threshold " + String(threshold) + " ratio " + String(ratio)
+									+ " attack " + String(attack) + " release " + String(release)
+									+ " gains " + String(gainIn) + "/" + String(gainOut));
+
+							++numRuns;
+						}
+
+		logMessage(String(numRuns) + " settings, worst difference " + String(worst));
+		expectLessThan(worst, 1.0e-5f, "processBlock drifted from the juce::dsp reference chain");
+
+		beginTest("Golden output at other sample rates and in mono");
+
+		for (auto otherSampleRate : { 48000.0, 96000.0 })
+			for (auto otherNumChannels : { 1, 2 })
+			{
+				auto signal = makeTestSignal(otherNumChannels, (int)otherSampleRate / 4, otherSampleRate, 2);
+
+				Settings settings;
+				settings.bands[0].threshold = -24;
+				settings.bands[1].threshold = -18;
+				settings.bands[2].threshold = -12;
+
+				PreparedProcessor prepared(otherSampleRate, maximumBlockSize, otherNumChannels);
+				applySettings(settings, prepared.processor.apvts);
+
+				AudioBuffer<float> actual(signal);
+				prepared.process(actual, getVaryingBlockSizes());
+
+				ReferenceChain reference(otherSampleRate, maximumBlockSize, otherNumChannels);
+				AudioBuffer<float> expected(signal);
+				reference.process(expected, readSettings(prepared.processor.apvts), getVaryingBlockSizes());
+
+				expectLessThan(maxAbsDifference(actual, expected), 1.0e-5f,
+					String(otherSampleRate) + " Hz, " + String(otherNumChannels) + " channel(s)");
+			}
+	}
+
+	void testCrossoverNull()
+	{
+		beginTest("Bands summed with the compressors bypassed equal the allpassed input");
+
+		const std::array<std::pair<float, float>, 4> crossovers{ { { 20, 1000 }, { 600, 3500 }, { 250, 8000 }, { 999, 20000 } } };
+
+		for (auto [lowMid, midHigh] : crossovers)
+		{
+			auto settings = linearSettings(lowMid, midHigh);
+			auto input = makeSignalAfterWarmUp((int)sampleRate / 4, 3);
+
+			auto actual = processWithSettings(settings, input);
+
+			// LP4 + HP4 at one crossover is the second-order allpass at that crossover,
+			// and the low band is also run through the allpass at fc1, so the sum is
+			// the input through both allpasses in series.
+			AudioBuffer<float> expected(input);
+			{
+				ProcessSpec spec{ sampleRate, (uint32)expected.getNumSamples(), (uint32)numChannels };
+				LinkwitzRileyFilter<float> allpass0, allpass1;
+
+				for (auto [filter, cutoff] : { std::make_pair(&allpass0, lowMid), std::make_pair(&allpass1, midHigh) })
+				{
+					filter->setType(LinkwitzRileyFilterType::allpass);
+					filter->prepare(spec);
+					filter->setCutoffFrequency(cutoff);
+
+					AudioBlock<float> block(expected);
+					filter->process(ProcessContextReplacing<float>(block));
+				}
+			}
+
+			auto label = String(lowMid) + " / " + String(midHigh) + " Hz";
+			expectLessThan(maxAbsDifference(actual, expected, warmUpSamples), 1.0e-4f, label);
+
+			// The allpasses shift the phase, so an identity processor would fail the test above.
+			expectGreaterThan(maxAbsDifference(actual, input, warmUpSamples), 1.0e-2f, label + " differs from the dry input");
+		}
+	}
+
+	void testMuteSoloRouting()
+	{
+		beginTest("Mute/solo routing matches the reference for every combination");
+
+		const auto input = makeSignalAfterWarmUp((int)sampleRate / 8, 4);
+
+		for (int combination = 0; combination < 64; ++combination)
+		{
+			auto settings = linearSettings(400, 5000);
+
+			for (size_t i = 0; i < settings.bands.size(); ++i)
+			{
+				settings.bands[i].isMuted = (combination & (1 << i)) != 0;
+				settings.bands[i].isSoloed = (combination & (8 << i)) != 0;
+			}
+
+			auto actual = processWithSettings(settings, input);
+
+			ReferenceChain reference(sampleRate, maximumBlockSize, numChannels);
+			AudioBuffer<float> expected(input);
+			reference.process(expected, settings, getVaryingBlockSizes());
+
+			expectLessThan(maxAbsDifference(actual, expected), 1.0e-5f, "mute/solo combination " + String(combination));
+		}
+
+		beginTest("Muting every band is silent");
+		{
+			auto settings = linearSettings(400, 5000);
+
+			for (auto& band : settings.bands)
+				band.isMuted = true;
+
+			expectLessOrEqual(maxAbs(processWithSettings(settings, input)), 0.f);
+		}
+
+		beginTest("Solo overrides mute");
+		{
+			auto soloOnly = linearSettings(400, 5000);
+			soloOnly.bands[1].isSoloed = true;
+
+			auto soloAndMuted = soloOnly;
+			soloAndMuted.bands[1].isMuted = true;
+			soloAndMuted.bands[0].isMuted = true;
+
+			auto expected = processWithSettings(soloOnly, input);
+			expectGreaterThan(maxAbs(expected, warmUpSamples), 1.0e-2f, "the soloed band carries signal");
+			expectLessOrEqual(maxAbsDifference(processWithSettings(soloAndMuted, input), expected), 0.f);
+		}
+
+		beginTest("Soloing every band equals soloing none");
+		{
+			auto none = linearSettings(400, 5000);
+			auto all = none;
+
+			for (auto& band : all.bands)
+				band.isSoloed = true;
+
+			expectLessOrEqual(maxAbsDifference(processWithSettings(all, input), processWithSettings(none, input)), 0.f);
+		}
+
+		beginTest("The soloed bands add up to the full mix");
+		{
+			auto full = processWithSettings(linearSettings(400, 5000), input);
+
+			AudioBuffer<float> sum(numChannels, input.getNumSamples());
+			sum.clear();
+
+			for (size_t i = 0; i < 3; ++i)
+			{
+				auto settings = linearSettings(400, 5000);
+				settings.bands[i].isSoloed = true;
+
+				auto band = processWithSettings(settings, input);
+				expectGreaterThan(maxAbs(band, warmUpSamples), 1.0e-3f, "band " + String((int)i) + " carries signal");
+
+				for (int ch = 0; ch < numChannels; ++ch)
+					sum.addFrom(ch, 0, band, ch, 0, band.getNumSamples());
+			}
+
+			expectLessThan(maxAbsDifference(sum, full), 1.0e-5f);
+		}
+	}
+};
+
+static ProcessorOutputTests processorOutputTests;
@@ -0,0 +1,163 @@
+/*
+  ==============================================================================
+
+	Catches heap allocations and blocking locks made on a thread while it is
+	marked as an audio thread.
+
+  ==============================================================================
+*/
+
+#include "RealtimeChecker.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+
+#include <dlfcn.h>
+#include <pthread.h>
+
+extern "C"
+{
+	void* __libc_malloc(size_t);
+	void* __libc_calloc(size_t, size_t);
+	void* __libc_realloc(void*, size_t);
+	void* __libc_memalign(size_t, size_t);
+	void __libc_free(void*);
+}
+
+namespace RealtimeChecker
+{
+	namespace
+	{
+		// initial-exec TLS is a plain segment offset: reading it never allocates.
+		__attribute__((tls_model("initial-exec"))) thread_local bool isAudioThread = false;
+
+		std::atomic<int> numAllocations{ 0 };
+		std::atomic<int> numDeallocations{ 0 };
+		std::atomic<int> numLocks{ 0 };
+
+		void note(std::atomic<int>& counter) noexcept
+		{
+			if (isAudioThread)
+				counter.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		template<typename Function>
+		Function resolveNext(std::atomic<Function>& cache, const char* name) noexcept
+		{
+			auto function = cache.load(std::memory_order_acquire);
+
+			if (function == nullptr)
+			{
+				function = reinterpret_cast<Function>(dlsym(RTLD_NEXT, name));
+				cache.store(function, std::memory_order_release);
+			}
+
+			return function;
+		}
+
+		using MutexLock = int (*)(pthread_mutex_t*);
+		using RwLock = int (*)(pthread_rwlock_t*);
+
+		std::atomic<MutexLock> realMutexLock{ nullptr };
+		std::atomic<RwLock> realRdLock{ nullptr };
+		std::atomic<RwLock> realWrLock{ nullptr };
+	}
+
+	ScopedAudioThread::ScopedAudioThread() noexcept { isAudioThread = true; }
+	ScopedAudioThread::~ScopedAudioThread() noexcept { isAudioThread = false; }
+
+	void reset() noexcept
+	{
+		numAllocations = 0;
+		numDeallocations = 0;
+		numLocks = 0;
+	}
+
+	Report getReport() noexcept
+	{
+		Report report;
+		report.allocations = numAllocations.load();
+		report.deallocations = numDeallocations.load();
+		report.locks = numLocks.load();
+		return report;
+	}
+}
+
+//==============================================================================
+// Interposed C library entry points. operator new/delete in libstdc++ end up here too.
+
+using namespace RealtimeChecker;
+
+extern "C"
+{
+	void* malloc(size_t size) noexcept
+	{
+		note(numAllocations);
+		return __libc_malloc(size);
+	}
+
+	void* calloc(size_t count, size_t size) noexcept
+	{
+		note(numAllocations);
+		return __libc_calloc(count, size);
+	}
+
+	void* realloc(void* ptr, size_t size) noexcept
+	{
+		note(numAllocations);
+		return __libc_realloc(ptr, size);
+	}
+
+	void free(void* ptr) noexcept
+	{
+		if (ptr != nullptr)
+			note(numDeallocations);
+
+		__libc_free(ptr);
+	}
+
+	void* memalign(size_t alignment, size_t size) noexcept
+	{
+		note(numAllocations);
+		return __libc_memalign(alignment, size);
+	}
+
+	void* aligned_alloc(size_t alignment, size_t size) noexcept
+	{
+		note(numAllocations);
+		return __libc_memalign(alignment, size);
+	}
+
+	int posix_memalign(void** result, size_t alignment, size_t size) noexcept
+	{
+		note(numAllocations);
+
+		auto* ptr = __libc_memalign(alignment, size);
+
+		if (ptr == nullptr)
+			return ENOMEM;
+
+		*result = ptr;
+		return 0;
+	}
+
+	int pthread_mutex_lock(pthread_mutex_t* mutex) noexcept
+	{
+		note(numLocks);
+		return resolveNext(realMutexLock, "pthread_mutex_lock")(mutex);
+	}
+
+	int pthread_rwlock_rdlock(pthread_rwlock_t* lock) noexcept
+	{
+		note(numLocks);
+		return resolveNext(realRdLock, "pthread_rwlock_rdlock")(lock);
+	}
+
+	int pthread_rwlock_wrlock(pthread_rwlock_t* lock) noexcept
+	{
+		note(numLocks);
+		return resolveNext(realWrLock, "pthread_rwlock_wrlock")(lock);
+	}
+}
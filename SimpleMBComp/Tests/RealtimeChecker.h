@@ -0,0 +1,43 @@
+/*
+  ==============================================================================
+
+	Catches heap allocations and blocking locks made on a thread while it is
+	marked as an audio thread.
+
+	The checker replaces malloc/free and friends and pthread mutex/rwlock
+	locking for the whole test executable (Linux/glibc only). Calls made on
+	any other thread, or outside a ScopedAudioThread, pass straight through.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+namespace RealtimeChecker
+{
+	struct Report
+	{
+		int allocations{ 0 };
+		int deallocations{ 0 };
+		int locks{ 0 };
+
+		int total() const noexcept { return allocations + deallocations + locks; }
+	};
+
+	/** Treats the calling thread as the audio thread while this object is alive. */
+	class ScopedAudioThread
+	{
+	public:
+		ScopedAudioThread() noexcept;
+		~ScopedAudioThread() noexcept;
+
+		ScopedAudioThread(const ScopedAudioThread&) = delete;
+		ScopedAudioThread& operator=(const ScopedAudioThread&) = delete;
+	};
+
+	/** Clears the counters. */
+	void reset() noexcept;
+
+	/** What has been caught since the last reset(). */
+	Report getReport() noexcept;
+}
@@ -0,0 +1,197 @@
+/*
+  ==============================================================================
+
+	Realtime-safety tests: processBlock must not allocate, free or take a
+	lock, whatever the block size and however the state changed since the
+	last block, and host automation must not allocate or free.
+
+  ==============================================================================
+*/
+
+#include "RealtimeChecker.h"
+#include "TestHelpers.h"
+
+using namespace TestHelpers;
+
+namespace
+{
+	constexpr int maximumBlockSize = 512;
+
+	String describe(const RealtimeChecker::Report& report)
+	{
+		return String(report.allocations) + " allocation(s), "
+			+ String(report.deallocations) + " deallocation(s), "
+			+ String(report.locks) + " lock(s)";
+	}
+
+	MemoryBlock makeState(const Settings& settings)
+	{
+		SimpleMBCompAudioProcessor source;
+		applySettings(settings, source.apvts);
+
+		MemoryBlock state;
+		source.getStateInformation(state);
+		return state;
+	}
+}
+
+//==============================================================================
+class RealtimeSafetyTests : public UnitTest
+{
+public:
+	RealtimeSafetyTests() : UnitTest("Realtime safety", "SimpleMBComp") {}
+
+	void runTest() override
+	{
+		testChecker();
+
+		for (auto numChannels : { 1, 2 })
+			for (auto sampleRate : { 44100.0, 96000.0 })
+				testProcessBlock(sampleRate, numChannels);
+	}
+
+private:
+	void testChecker()
+	{
+		beginTest("The checker catches allocations and locks on the audio thread");
+		{
+			RealtimeChecker::reset();
+			{
+				RealtimeChecker::ScopedAudioThread audioThread;
+				std::vector<float> v(64);
+				ignoreUnused(v);
+			}
+			auto report = RealtimeChecker::getReport();
+			expectGreaterThan(report.allocations, 0);
+			expectGreaterThan(report.deallocations, 0);
+
+			CriticalSection lock;
+
+			RealtimeChecker::reset();
+			{
+				RealtimeChecker::ScopedAudioThread audioThread;
+				const ScopedLock sl(lock);
+			}
+			expectGreaterThan(RealtimeChecker::getReport().locks, 0);
+		}
+
+		beginTest("The checker catches AudioBuffer copy-assignment at a new block size");
+		{
+			// What splitBands used to do with its band buffers.
+			AudioBuffer<float> band(2, maximumBlockSize);
+			AudioBuffer<float> storage(2, maximumBlockSize);
+			AudioBuffer<float> block(storage.getArrayOfWritePointers(), 2, 0, 100);
+
+			RealtimeChecker::reset();
+			{
+				RealtimeChecker::ScopedAudioThread audioThread;
+				band = block;
+			}
+			expectGreaterThan(RealtimeChecker::getReport().allocations, 0);
+		}
+	}
+
+	void testProcessBlock(double sampleRate, int numChannels)
+	{
+		beginTest("processBlock is realtime-safe at " + String(sampleRate) + " Hz with "
+			+ String(numChannels) + " channel(s) and changing block sizes");
+
+		Settings soloed;
+		soloed.lowMidCrossover = 250;
+		soloed.midHighCrossover = 9000;
+		soloed.bands[1].isSoloed = true;
+		soloed.bands[2].isBypassed = true;
+
+		Settings heavy;
+		heavy.inputGain = 12;
+		heavy.outputGain = -6;
+
+		for (auto& band : heavy.bands)
+		{
+			band.threshold = -40;
+			band.ratio = 20;
+			band.attack = 5;
+			band.release = 480;
+		}
+
+		// States are built up front: building them allocates, and so does
+		// setStateInformation itself. Hosts call that on the message thread,
+		// so it runs outside the checker and only processBlock after it is
+		// checked.
+		const std::array<MemoryBlock, 2> states{ makeState(soloed), makeState(heavy) };
+
+		PreparedProcessor prepared(sampleRate, maximumBlockSize, numChannels);
+		auto signal = makeTestSignal(numChannels, maximumBlockSize * 8, sampleRate, 5);
+
+		RealtimeChecker::Report total;
+
+		for (int round = 0; round < 12; ++round)
+		{
+			// Between blocks, change the state the way a host or the editor would.
+			// updateState picks the change up inside the next processBlock.
+			switch (round % 4)
+			{
+				case 0: break;
+				case 1:
+					prepared.processor.setStateInformation(states[0].getData(), (int)states[0].getSize());
+					expect(readSettings(prepared.processor.apvts).bands[1].isSoloed, "setStateInformation took effect");
+					break;
+				case 2: prepared.processor.setStateInformation(states[1].getData(), (int)states[1].getSize()); break;
+				default:
+				{
+					Settings swept;
+					swept.lowMidCrossover = 100.f + 70.f * (float)round;
+					swept.midHighCrossover = 2000.f + 1000.f * (float)round;
+					swept.bands[0].attack = 10.f + (float)round;
+					swept.bands[2].release = 300.f - (float)round;
+					swept.bands[0].isMuted = true;
+
+					// Hosts send automation from the audio thread, so it is checked too.
+					RealtimeChecker::reset();
+					{
+						RealtimeChecker::ScopedAudioThread audioThread;
+						applySettings(swept, prepared.processor.apvts);
+					}
+
+					// Known hit, allowed: setValueNotifyingHost notifies the listeners under
+					// JUCE's AudioProcessorParameter and AudioProcessor listenerLocks, which
+					// are CriticalSections held only while the listeners are called. That is
+					// JUCE's code rather than ours, so the locks are reported, not failed.
+					auto report = RealtimeChecker::getReport();
+
+					if (report.locks > 0)
+						logMessage("Host automation in round " + String(round) + ": " + String(report.locks)
+							+ " lock(s) in JUCE's parameter listener notification (allowed)");
+
+					expectEquals(report.allocations + report.deallocations, 0, "host automation: " + describe(report));
+					break;
+				}
+			}
+
+			AudioBuffer<float> buffer(signal);
+
+			processInBlocks(buffer, getVaryingBlockSizes(), [&](AudioBuffer<float>& block)
+			{
+				RealtimeChecker::reset();
+				{
+					RealtimeChecker::ScopedAudioThread audioThread;
+					prepared.processor.processBlock(block, prepared.midi);
+				}
+
+				auto report = RealtimeChecker::getReport();
+
+				if (report.total() > 0)
+					logMessage("Block of " + String(block.getNumSamples()) + " samples in round "
+						+ String(round) + ": " + describe(report));
+
+				total.allocations += report.allocations;
+				total.deallocations += report.deallocations;
+				total.locks += report.locks;
+			});
+		}
+
+		expectEquals(total.total(), 0, describe(total));
+	}
+};
+
+static RealtimeSafetyTests realtimeSafetyTests;
@@ -0,0 +1,325 @@
+/*
+  ==============================================================================
+
+	Shared fixtures for the SimpleMBComp tests: parameter settings, test
+	signals, block-wise processing and the reference chain built from the
+	stock juce::dsp classes the processor's signal path is defined by.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "PluginProcessor.h"
+
+namespace TestHelpers
+{
+	struct BandSettings
+	{
+		float threshold{ 0 };
+		float ratio{ 2 };
+		float attack{ 50 };
+		float release{ 250 };
+		bool isBypassed{ false };
+		bool isMuted{ false };
+		bool isSoloed{ false };
+	};
+
+	struct Settings
+	{
+		float lowMidCrossover{ 600 };
+		float midHighCrossover{ 3500 };
+		float inputGain{ 0 };
+		float outputGain{ 0 };
+		std::array<BandSettings, 3> bands;
+	};
+
+	inline Params::Names forBand(Params::Names lowBandName, size_t band)
+	{
+		return static_cast<Params::Names>(static_cast<size_t>(lowBandName) + band);
+	}
+
+	inline RangedAudioParameter& getParameter(AudioProcessorValueTreeState& apvts, Params::Names name)
+	{
+		auto* param = apvts.getParameter(Params::GetParams().at(name));
+		jassert(param != nullptr);
+		return *param;
+	}
+
+	/** Pushes the settings into the parameters, the way a host would. */
+	inline void applySettings(const Settings& settings, AudioProcessorValueTreeState& apvts)
+	{
+		using namespace Params;
+
+		auto setFloat = [&apvts](Names name, float value)
+		{
+			auto& param = getParameter(apvts, name);
+			param.setValueNotifyingHost(param.convertTo0to1(value));
+		};
+
+		auto setBool = [&apvts](Names name, bool value)
+		{
+			getParameter(apvts, name).setValueNotifyingHost(value ? 1.f : 0.f);
+		};
+
+		setFloat(Low_Mid_Crossover_Freq, settings.lowMidCrossover);
+		setFloat(Mid_High_Crossover_Freq, settings.midHighCrossover);
+		setFloat(Gain_In, settings.inputGain);
+		setFloat(Gain_Out, settings.outputGain);
+
+		for (size_t i = 0; i < settings.bands.size(); ++i)
+		{
+			const auto& band = settings.bands[i];
+
+			setFloat(forBand(Threshold_Low_Band, i), band.threshold);
+			setFloat(forBand(Ratio_Low_Band, i), band.ratio);
+			setFloat(forBand(Attack_Low_Band, i), band.attack);
+			setFloat(forBand(Release_Low_Band, i), band.release);
+			setBool(forBand(Bypassed_Low_Band, i), band.isBypassed);
+			setBool(forBand(Mute_Low_Band, i), band.isMuted);
+			setBool(forBand(Solo_Low_Band, i), band.isSoloed);
+		}
+	}
+
+	/** Reads back what the parameters actually hold after range snapping. */
+	inline Settings readSettings(AudioProcessorValueTreeState& apvts)
+	{
+		using namespace Params;
+
+		auto getFloat = [&apvts](Names name)
+		{
+			return dynamic_cast<AudioParameterFloat&>(getParameter(apvts, name)).get();
+		};
+
+		auto getBool = [&apvts](Names name)
+		{
+			return dynamic_cast<AudioParameterBool&>(getParameter(apvts, name)).get();
+		};
+
+		Settings settings;
+		settings.lowMidCrossover = getFloat(Low_Mid_Crossover_Freq);
+		settings.midHighCrossover = getFloat(Mid_High_Crossover_Freq);
+		settings.inputGain = getFloat(Gain_In);
+		settings.outputGain = getFloat(Gain_Out);
+
+		for (size_t i = 0; i < settings.bands.size(); ++i)
+		{
+			auto& band = settings.bands[i];
+
+			band.threshold = getFloat(forBand(Threshold_Low_Band, i));
+			band.ratio = getFloat(forBand(Ratio_Low_Band, i));
+			band.attack = getFloat(forBand(Attack_Low_Band, i));
+			band.release = getFloat(forBand(Release_Low_Band, i));
+			band.isBypassed = getBool(forBand(Bypassed_Low_Band, i));
+			band.isMuted = getBool(forBand(Mute_Low_Band, i));
+			band.isSoloed = getBool(forBand(Solo_Low_Band, i));
+		}
+
+		return settings;
+	}
+
+	/** Noise with a slow amplitude envelope, so the compressors attack and release. */
+	inline AudioBuffer<float> makeTestSignal(int numChannels, int numSamples, double sampleRate, int seed)
+	{
+		AudioBuffer<float> buffer(numChannels, numSamples);
+		Random random(seed);
+
+		for (int ch = 0; ch < numChannels; ++ch)
+		{
+			auto* data = buffer.getWritePointer(ch);
+
+			for (int i = 0; i < numSamples; ++i)
+			{
+				auto envelope = 0.5 + 0.5 * std::sin(MathConstants<double>::twoPi * 3.0 * i / sampleRate);
+				data[i] = (float)(0.8 * envelope * (random.nextDouble() * 2.0 - 1.0));
+			}
+		}
+
+		return buffer;
+	}
+
+	/** Block sizes that change on every call, including single samples and the maximum. */
+	inline const std::vector<int>& getVaryingBlockSizes()
+	{
+		static const std::vector<int> sizes{ 512, 64, 511, 1, 256, 512, 17, 300, 2, 480 };
+		return sizes;
+	}
+
+	/**
+		Calls process(view) over consecutive views of the buffer, cycling through
+		the given block sizes. The views refer to the buffer's own memory, so
+		creating them does not allocate.
+	*/
+	template<typename ProcessFunction>
+	void processInBlocks(AudioBuffer<float>& buffer, const std::vector<int>& blockSizes, ProcessFunction&& process)
+	{
+		auto numSamples = buffer.getNumSamples();
+		size_t blockIndex = 0;
+
+		for (int start = 0; start < numSamples; )
+		{
+			auto blockSize = jmin(blockSizes[blockIndex++ % blockSizes.size()], numSamples - start);
+			AudioBuffer<float> view(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), start, blockSize);
+			process(view);
+			start += blockSize;
+		}
+	}
+
+	inline float maxAbsDifference(const AudioBuffer<float>& a, const AudioBuffer<float>& b, int startSample = 0)
+	{
+		jassert(a.getNumChannels() == b.getNumChannels());
+		jassert(a.getNumSamples() == b.getNumSamples());
+
+		float result = 0;
+
+		for (int ch = 0; ch < a.getNumChannels(); ++ch)
+			for (int i = startSample; i < a.getNumSamples(); ++i)
+				result = jmax(result, std::abs(a.getSample(ch, i) - b.getSample(ch, i)));
+
+		return result;
+	}
+
+	inline float maxAbs(const AudioBuffer<float>& buffer, int startSample = 0)
+	{
+		return buffer.getMagnitude(startSample, buffer.getNumSamples() - startSample);
+	}
+
+	//==============================================================================
+	struct PreparedProcessor
+	{
+		PreparedProcessor(double sampleRate, int maximumBlockSize, int numChannels)
+		{
+			processor.setPlayConfigDetails(numChannels, numChannels, sampleRate, maximumBlockSize);
+			processor.prepareToPlay(sampleRate, maximumBlockSize);
+		}
+
+		void process(AudioBuffer<float>& buffer, const std::vector<int>& blockSizes)
+		{
+			processInBlocks(buffer, blockSizes, [this](auto& block) { processor.processBlock(block, midi); });
+		}
+
+		SimpleMBCompAudioProcessor processor;
+		MidiBuffer midi;
+	};
+
+	//==============================================================================
+	/**
+		The processor's signal path written directly with the stock juce::dsp
+		LinkwitzRileyFilter, Compressor and Gain classes. processBlock must
+		match it: this is the golden model the output tests compare against.
+	*/
+	class ReferenceChain
+	{
+	public:
+		ReferenceChain(double sampleRate, int maximumBlockSize, int numChannels)
+		{
+			ProcessSpec spec{ sampleRate, (uint32)maximumBlockSize, (uint32)numChannels };
+
+			for (auto& comp : compressors)
+				comp.prepare(spec);
+
+			LP1.setType(LinkwitzRileyFilterType::lowpass);
+			HP1.setType(LinkwitzRileyFilterType::highpass);
+			AP2.setType(LinkwitzRileyFilterType::allpass);
+			LP2.setType(LinkwitzRileyFilterType::lowpass);
+			HP2.setType(LinkwitzRileyFilterType::highpass);
+
+			for (auto* filter : { &LP1, &HP1, &AP2, &LP2, &HP2 })
+				filter->prepare(spec);
+
+			for (auto* gain : { &inputGain, &outputGain })
+			{
+				gain->prepare(spec);
+				gain->setRampDurationSeconds(0.05);
+			}
+
+			for (auto& band : bands)
+				band.setSize(numChannels, maximumBlockSize);
+		}
+
+		void process(AudioBuffer<float>& buffer, const Settings& settings)
+		{
+			for (size_t i = 0; i < compressors.size(); ++i)
+			{
+				compressors[i].setAttack(settings.bands[i].attack);
+				compressors[i].setRelease(settings.bands[i].release);
+				compressors[i].setThreshold(settings.bands[i].threshold);
+				compressors[i].setRatio(settings.bands[i].ratio);
+			}
+
+			LP1.setCutoffFrequency(settings.lowMidCrossover);
+			HP1.setCutoffFrequency(settings.lowMidCrossover);
+			AP2.setCutoffFrequency(settings.midHighCrossover);
+			LP2.setCutoffFrequency(settings.midHighCrossover);
+			HP2.setCutoffFrequency(settings.midHighCrossover);
+
+			inputGain.setGainDecibels(settings.inputGain);
+			outputGain.setGainDecibels(settings.outputGain);
+
+			auto numChannels = buffer.getNumChannels();
+			auto numSamples = buffer.getNumSamples();
+
+			{
+				AudioBlock<float> block(buffer);
+				inputGain.process(ProcessContextReplacing<float>(block));
+			}
+
+			for (auto& band : bands)
+			{
+				band.setSize(numChannels, numSamples, false, false, true);
+
+				for (int ch = 0; ch < numChannels; ++ch)
+					band.copyFrom(ch, 0, buffer, ch, 0, numSamples);
+			}
+
+			AudioBlock<float> low(bands[0]), mid(bands[1]), high(bands[2]);
+
+			LP1.process(ProcessContextReplacing<float>(low));
+			AP2.process(ProcessContextReplacing<float>(low));
+			HP1.process(ProcessContextReplacing<float>(mid));
+			high.copyFrom(mid);
+			LP2.process(ProcessContextReplacing<float>(mid));
+			HP2.process(ProcessContextReplacing<float>(high));
+
+			for (size_t i = 0; i < compressors.size(); ++i)
+			{
+				AudioBlock<float> block(bands[i]);
+				ProcessContextReplacing<float> context(block);
+				context.isBypassed = settings.bands[i].isBypassed;
+				compressors[i].process(context);
+			}
+
+			auto isAnySoloed = std::any_of(settings.bands.begin(), settings.bands.end(),
+				[](const BandSettings& band) { return band.isSoloed; });
+
+			buffer.clear();
+
+			for (size_t i = 0; i < bands.size(); ++i)
+			{
+				auto isAudible = isAnySoloed ? settings.bands[i].isSoloed : !settings.bands[i].isMuted;
+
+				if (isAudible)
+					for (int ch = 0; ch < numChannels; ++ch)
+						buffer.addFrom(ch, 0, bands[i], ch, 0, numSamples);
+			}
+
+			{
+				AudioBlock<float> block(buffer);
+				outputGain.process(ProcessContextReplacing<float>(block));
+			}
+		}
+
+		void process(AudioBuffer<float>& buffer, const Settings& settings, const std::vector<int>& blockSizes)
+		{
+			processInBlocks(buffer, blockSizes, [this, &settings](auto& block) { process(block, settings); });
+		}
+
+	private:
+		std::array<Compressor<float>, 3> compressors;
+		LinkwitzRileyFilter<float> LP1, AP2, HP1, LP2, HP2;
+		Gain<float> inputGain, outputGain;
+		std::array<AudioBuffer<float>, 3> bands;
+	};
+}
@@ -0,0 +1,25 @@
+/*
+  ==============================================================================
+
+	Runs every SimpleMBComp unit test and returns non-zero if any failed.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+
+int main()
+{
+	juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+	juce::UnitTestRunner runner;
+	runner.setAssertOnFailure(false);
+	runner.runTestsInCategory("SimpleMBComp");
+
+	int numFailures = 0;
+
+	for (int i = 0; i < runner.getNumResults(); ++i)
+		numFailures += runner.getResult(i)->failures;
+
+	return runner.getNumResults() > 0 && numFailures == 0 ? 0 : 1;
+}